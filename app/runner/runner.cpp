@@ -51,8 +51,22 @@ static pcs::Environment LoadMachine(const std::string& data_folder, size_t num_r
 	return machine;
 }
 
-static void CompleteTopology(pcs::Environment& machine) {
-	machine.Complete();
+/*
+ * @brief With snapshot set, the topology is mapped from the snapshot of these resources in the data folder if there is one,
+ * otherwise it is computed and the snapshot is written for the next run.
+ */
+static void CompleteTopology(pcs::Environment& machine, bool snapshot) {
+	if (!snapshot) {
+		machine.Complete();
+		return;
+	}
+	std::string snapshot_file = machine.SnapshotName();
+	if (std::filesystem::exists(snapshot_file)) {
+		machine.LoadSnapshot(snapshot_file);
+	} else {
+		machine.Complete();
+		machine.SaveSnapshot(snapshot_file);
+	}
 }
 
 static void IncrementalTopology(pcs::Environment& machine) {
@@ -126,10 +140,12 @@ void Run(const std::string& name, const RunnerOpts& opts) {
 	nightly::ExportToFile(recipe.lts(), export_folder + "/recipe.gv");
 
 	pcs::Environment machine = LoadMachine(data_folder, num_resources);
-	if (opts.incremental_topology) {
+	if (opts.auto_topology) {
+		machine.AutoTopology();
+	} else if (opts.incremental_topology) {
 		IncrementalTopology(machine);
 	} else {
-		CompleteTopology(machine);
+		CompleteTopology(machine, opts.snapshot_topology);
 	}
 
 
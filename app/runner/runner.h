@@ -25,6 +25,8 @@ struct RunnerOpts {
 	bool only_highlighted_topology_image; // Exports the highlighted topology only, rather than topology & highlighted topology
 	bool skeleton_topology_image;
 	std::string recipe_name;
+	bool snapshot_topology = false; // Maps the complete topology from a snapshot in the data folder, writing it on the first run
+	bool auto_topology = false; // Picks the complete or incremental topology from an estimate of its size, overrides incremental_topology
 };
 
 void Run(const std::string& name, const RunnerOpts& opts);
@@ -33,7 +35,7 @@ static size_t NumOfResources(const std::filesystem::path& data_folder);
 
 static pcs::Environment LoadMachine(const std::string& data_folder, size_t num_resources);
 static pcs::Recipe LoadRecipe(const std::string& data_folder, const std::string& recipe_file);
-static void CompleteTopology(pcs::Environment& machine);
+static void CompleteTopology(pcs::Environment& machine, bool snapshot);
 static void IncrementalTopology(pcs::Environment& machine);
 static void GraphVizSave(const std::string& export_folder, size_t num_resources, bool only_highlighted_topology, bool skeleton_topology);
 static void ControllerGraphVizSave();
\ No newline at end of file
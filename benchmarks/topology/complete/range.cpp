@@ -20,9 +20,24 @@ static void BM_TopologyRange(benchmark::State& state) {
     }
 }
 
+static void BM_TopologyRangeParallel(benchmark::State& state) {
+    std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>> ltss;
+    ltss.resize(state.range(0));
+    for (size_t i = 0; i < state.range(0); ++i) {
+        nightly::ReadFromFile(ltss[i], "../../data/pad/Resource1.txt");
+    }
+
+    for (auto _ : state) {
+        pcs::CompleteTopology topology(ltss, false, state.range(1));
+        benchmark::DoNotOptimize(topology);
+        benchmark::ClobberMemory();
+    }
+}
+
 // BENCHMARK(BM_TopologyRange)->Arg(6)->Iterations(1000)->Unit(benchmark::kMillisecond);
 
 BENCHMARK(BM_TopologyRange)->DenseRange(2, 10, 1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TopologyRangeParallel)->ArgsProduct({ benchmark::CreateDenseRange(6, 10, 1), { 2, 4, 8 } })->Unit(benchmark::kMillisecond);
 
 //BENCHMARK_MAIN();
 int main(int argc, char** argv)
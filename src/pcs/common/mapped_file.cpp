@@ -0,0 +1,79 @@
+#include "pcs/common/mapped_file.h"
+
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace pcs {
+
+	/*
+	 * @exception Throws std::runtime_error if the file cannot be opened or mapped
+	 */
+#if defined(_WIN32)
+	MappedFile::MappedFile(const std::filesystem::path& path) {
+		HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) {
+			throw std::runtime_error("Could not open " + path.string());
+		}
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+			CloseHandle(file);
+			throw std::runtime_error("Could not map " + path.string());
+		}
+		HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		void* view = (mapping != nullptr) ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (view == nullptr) {
+			if (mapping != nullptr) {
+				CloseHandle(mapping);
+			}
+			CloseHandle(file);
+			throw std::runtime_error("Could not map " + path.string());
+		}
+		file_ = file;
+		mapping_ = mapping;
+		data_ = static_cast<const std::byte*>(view);
+		size_ = static_cast<size_t>(size.QuadPart);
+	}
+
+	MappedFile::~MappedFile() {
+		UnmapViewOfFile(data_);
+		CloseHandle(mapping_);
+		CloseHandle(file_);
+	}
+#else
+	MappedFile::MappedFile(const std::filesystem::path& path) {
+		int fd = open(path.c_str(), O_RDONLY);
+		if (fd == -1) {
+			throw std::runtime_error("Could not open " + path.string());
+		}
+		struct stat info;
+		if (fstat(fd, &info) == -1 || info.st_size == 0) {
+			close(fd);
+			throw std::runtime_error("Could not map " + path.string());
+		}
+		void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (view == MAP_FAILED) {
+			throw std::runtime_error("Could not map " + path.string());
+		}
+		data_ = static_cast<const std::byte*>(view);
+		size_ = static_cast<size_t>(info.st_size);
+	}
+
+	MappedFile::~MappedFile() {
+		munmap(const_cast<std::byte*>(data_), size_);
+	}
+#endif
+
+}
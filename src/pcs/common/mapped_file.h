@@ -0,0 +1,34 @@
+#pragma once
+
+#include <filesystem>
+#include <cstddef>
+
+namespace pcs {
+
+	/**
+	 * @brief Read-only memory mapping of a whole file, unmapped when the object is destroyed.
+	 */
+	class MappedFile {
+	private:
+		const std::byte* data_ = nullptr;
+		size_t size_ = 0;
+#if defined(_WIN32)
+		void* file_ = nullptr;
+		void* mapping_ = nullptr;
+#endif
+	public:
+		MappedFile(const std::filesystem::path& path);
+		~MappedFile();
+		MappedFile(const MappedFile& other) = delete;
+		MappedFile& operator=(const MappedFile& other) = delete;
+
+		const std::byte* data() const {
+			return data_;
+		}
+
+		size_t size() const {
+			return size_;
+		}
+	};
+
+}
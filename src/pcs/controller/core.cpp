@@ -2,6 +2,12 @@
 
 #include <span>
 #include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <queue>
+#include <unordered_set>
+#include <utility>
 
 #include <spdlog/fmt/bundled/color.h>
 #include <spdlog/fmt/ranges.h>
@@ -11,6 +17,9 @@
 #include "pcs/common/log.h"
 #include "pcs/operation/task_expression.h"
 #include "pcs/operation/composite.h"
+#include "pcs/operation/parameterized_op.h"
+#include "pcs/product/recipe.h"
+#include "pcs/environment/environment.h"
 
 namespace pcs {
 
@@ -41,7 +50,7 @@ namespace pcs {
 			}
 			bool found_nop = false;
 			for (const auto& t : ltss[i].at(states_vec[i]).transitions()) {
-				if (t.label().operation() == "nop") {
+				if (t.label().IsNop()) {
 					found_nop = true;
 					break;
 				}
@@ -67,7 +76,7 @@ namespace pcs {
 			}
 			bool found_nop = false;
 			for (const auto& t : ltss[i].at(states_vec[i]).transitions()) {
-				if (t.label().operation() == "nop") {
+				if (t.label().IsNop()) {
 					found_nop = true;
 					break;
 				}
@@ -81,4 +90,81 @@ namespace pcs {
 		return true;
 	}
 
+	/*
+	 * @brief Operation id of every operation of the recipe, looked up once so that the solvers match transitions
+	 * against a recipe operation without going through the LabelTable. The ids stay valid while the topology lives.
+	 */
+	std::unordered_map<std::string, uint32_t> ResolveOperationIds(const Recipe& recipe) {
+		std::unordered_map<std::string, uint32_t> operation_ids;
+		for (const auto& name : recipe.Operations()) {
+			operation_ids.emplace(name, ParameterizedOp::OperationId(name));
+		}
+		return operation_ids;
+	}
+
+	/*
+	 * @brief Renames the topology states of the controller to original resource states. With minimised resources a
+	 * topology state names each block after one of its states, so the controller is walked from its initial state and
+	 * every resource taking part in a transition follows the original transition into the block it reached, see
+	 * Environment::OriginalSuccessor. The part of the controller for a later recipe state starts from a topology state
+	 * an earlier part reached, so the walk is resumed from every state whose topology state is already renamed. A
+	 * topology state reached along several paths keeps the names of the first.
+	 */
+	ControllerType OriginalStates(const ControllerType& controller, const Environment& machine) {
+		using ControllerState = std::pair<std::string, std::vector<std::string>>;
+		std::unordered_map<std::vector<std::string>, std::vector<std::string>, boost::hash<std::vector<std::string>>> original;
+		std::unordered_set<const ControllerState*> visited;
+		std::queue<const ControllerState*> queue;
+
+		auto walk = [&](const ControllerState& root) {
+			visited.emplace(&root);
+			queue.push(&root);
+			while (!queue.empty()) {
+				const ControllerState& state = *queue.front();
+				queue.pop();
+				const std::vector<std::string> from = original.at(state.second);
+				for (const auto& transition : controller.states().at(state).transitions_) {
+					const std::vector<std::string>& to = transition.to().second;
+					auto [it, inserted] = original.try_emplace(to, to);
+					if (inserted) {
+						for (size_t i = 0; i < to.size(); ++i) {
+							const std::string& operation = transition.label()[i];
+							it->second[i] = (operation == "-") ? from[i] : machine.OriginalSuccessor(i, from[i], operation, to[i]);
+						}
+					}
+					const ControllerState* next = &controller.states().find(transition.to())->first;
+					if (visited.emplace(next).second) {
+						queue.push(next);
+					}
+				}
+			}
+		};
+
+		const ControllerState* initial = &controller.states().find(controller.initial_state())->first;
+		original.emplace(initial->second, initial->second);
+		walk(*initial);
+		for (bool resumed = true; resumed;) {
+			resumed = false;
+			for (const auto& [state, _] : controller.states()) {
+				if (!visited.contains(&state) && original.contains(state.second)) {
+					walk(state);
+					resumed = true;
+				}
+			}
+		}
+
+		auto rename = [&original](const ControllerState& state) {
+			auto it = original.find(state.second);
+			return (it != original.end()) ? ControllerState(state.first, it->second) : state;
+		};
+		ControllerType renamed;
+		renamed.set_initial_state(rename(controller.initial_state()));
+		for (const auto& [state, s] : controller.states()) {
+			for (const auto& transition : s.transitions_) {
+				renamed.AddTransition(rename(state), transition.label(), rename(transition.to()));
+			}
+		}
+		return renamed;
+	}
+
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <span>
 #include <vector>
 #include <string>
+#include <unordered_map>
+#include <cstdint>
 
 #include <boost/container_hash/hash.hpp>
 
@@ -10,6 +12,8 @@
 #include "lts/lts.h"
 #include "pcs/operation/task_expression.h"
 #include "pcs/operation/composite.h"
+#include "pcs/product/recipe.h"
+#include "pcs/environment/environment.h"
 
 
 namespace pcs {
@@ -30,4 +34,12 @@ namespace pcs {
 		            const std::vector<std::string>& states_vec, size_t in, size_t out,
 				    const std::string& op_str);
 
+	std::unordered_map<std::string, uint32_t> ResolveOperationIds(const Recipe& recipe);
+
+	nightly::LTS<std::pair<std::string, std::vector<std::string>>, std::vector<std::string>,
+		         boost::hash<std::pair<std::string, std::vector<std::string>>>>
+		OriginalStates(const nightly::LTS<std::pair<std::string, std::vector<std::string>>, std::vector<std::string>,
+			                              boost::hash<std::pair<std::string, std::vector<std::string>>>>& controller,
+			           const Environment& machine);
+
 }
\ No newline at end of file
@@ -33,7 +33,8 @@ namespace pcs {
 		                       boost::hash<std::pair<std::string, std::vector<std::string>>>>;
 
 	BestController::BestController(const Environment* machine, ITopology* topology, const Recipe* recipe) 
-		: machine_(machine), recipe_(recipe), composite_ops_(recipe->lts().NumOfTransitions()), topology_(topology), num_of_resources_(machine_->NumOfResources()) {
+		: machine_(machine), recipe_(recipe), composite_ops_(recipe->lts().NumOfTransitions()), topology_(topology), num_of_resources_(machine_->NumOfResources()),
+		  operation_ids_(ResolveOperationIds(*recipe)) {
 	}
 
 	const CompositeOperation& BestController::GetComposite(const Stage& stage, const Recipe& recipe) {
@@ -98,8 +99,9 @@ namespace pcs {
 		const TaskExpression& task = co.CurrentTask(stage.seq_id);
 		const auto& [op, input, parameters, output] = task;
 
+		uint32_t op_id = operation_ids_.at(op.name());
 		for (const auto& transition : topology_->at(*stage.topology_state).transitions_) {
-			if (op.name() == transition.label().second.operation()) {
+			if (transition.label().second.operation_id() == op_id) {
 				bool allocate = true;
 				if (!input.empty()) {
 					allocate = stage.parts.Allocate(transition.label(), input);
@@ -124,14 +126,14 @@ namespace pcs {
 				}
 			}
 			else {
-				std::optional<TransferOperation> opt = StringToTransfer(transition.label().second.operation());
-				if (opt.has_value()) {
-					if (opt->IsOut()) {
-						std::get<0>(transfers[*opt]) = &(transition.to());
-						std::get<1>(transfers[*opt]) = &(transition.label());
+				if (transition.label().second.IsTransfer()) {
+					TransferOperation transfer = transition.label().second.transfer();
+					if (transfer.IsOut()) {
+						std::get<0>(transfers[transfer]) = &(transition.to());
+						std::get<1>(transfers[transfer]) = &(transition.label());
 					}
 					else {
-						TransferOperation inverse = opt->Inverse(); // The associated map key is the inverse
+						TransferOperation inverse = transfer.Inverse(); // The associated map key is the inverse
 						std::get<2>(transfers[inverse]) = &(transition.label());
 					}
 				}
@@ -184,7 +186,13 @@ namespace pcs {
 					Stage& next_stage = next_candidate.descendants.front();
 
 					// map type - [ TransferOperation key, tuple(end_state, transition, inverse transition) ]
+					if (std::get<1>(v) == nullptr || std::get<2>(v) == nullptr) { // Only one half of the transfer is in the topology
+						continue;
+					}
 					const TopologyState& state_vec = *std::get<0>(v);
+					if (topology_->IsDead(state_vec)) {
+						continue;
+					}
 					std::vector<std::string> label_vec(num_of_resources_, "-");
 					label_vec[std::get<1>(v)->first] = k.name();
 					label_vec[std::get<2>(v)->first] = std::get<2>(v)->second.operation();
@@ -244,6 +252,9 @@ namespace pcs {
 
 		best_candidate_ = best_candidate;
 
+		if (machine_->IsMinimised()) {
+			return { OriginalStates(best_candidate.controller, *machine_) };
+		}
 		return { best_candidate.controller };
 	}
 
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <optional>
+#include <unordered_map>
+#include <cstdint>
 #include <span>
 #include <string>
 #include <vector>
@@ -47,6 +49,8 @@ namespace pcs {
 
 		size_t num_of_resources_;
 		std::vector<double> costs_;
+		// Operation id of every recipe operation, see ResolveOperationIds
+		std::unordered_map<std::string, uint32_t> operation_ids_;
 
 		struct Stage {
 			const TopologyState* topology_state;
@@ -21,7 +21,8 @@
 namespace pcs {
 
 	Controller::Controller(const Environment* machine, ITopology* topology, const Recipe* recipe)
-		: machine_(machine), recipe_(recipe), topology_(topology), num_of_resources_(machine_->NumOfResources()) {}
+		: machine_(machine), recipe_(recipe), topology_(topology), num_of_resources_(machine_->NumOfResources()),
+		  operation_ids_(ResolveOperationIds(*recipe)) {}
 
 	std::optional<Controller::ControllerType> Controller::Generate() {
 		const std::string& recipe_init_state = recipe_->lts().initial_state();
@@ -41,6 +42,10 @@ namespace pcs {
 
 		PCS_INFO(fmt::format(fmt::fg(fmt::color::light_green), "Controller generation completed: realisability = {}", generated));
 		
+		if (machine_->IsMinimised()) {
+			controller = OriginalStates(controller, *machine_);
+		}
+
 		/* ******************************************************************************************* /
 		  * @Hack: Visualises controller no matter what (wherever it reached) for testing purposes.
 		  *	However, doesn't affect above realisability output though
@@ -76,8 +81,9 @@ namespace pcs {
 		
 
 		bool found = false;
+		uint32_t op_id = operation_ids_.at(op.name());
 		for (const auto& transition : topology_->at(*topology_state).transitions_) {
-			if (op.name() == transition.label().second.operation()) {
+			if (transition.label().second.operation_id() == op_id) {
 				bool allocate = true;
 				if (!input.empty()) {
 					allocate = plan_parts.Allocate(transition.label(), input);
@@ -99,13 +105,13 @@ namespace pcs {
 					break;
 				}
 			} else {
-				std::optional<TransferOperation> opt = StringToTransfer(transition.label().second.operation());
-				if (opt.has_value()) {
-					if (opt->IsOut()) {
-						std::get<0>(transfers[*opt]) = &(transition.to());
-						std::get<1>(transfers[*opt]) = &(transition.label());
+				if (transition.label().second.IsTransfer()) {
+					TransferOperation transfer = transition.label().second.transfer();
+					if (transfer.IsOut()) {
+						std::get<0>(transfers[transfer]) = &(transition.to());
+						std::get<1>(transfers[transfer]) = &(transition.label());
 					} else {
-						TransferOperation inverse = opt->Inverse(); // The associated map key is the inverse
+						TransferOperation inverse = transfer.Inverse(); // The associated map key is the inverse
 						std::get<2>(transfers[inverse]) = &(transition.label());
 					}
 				}
@@ -117,7 +123,13 @@ namespace pcs {
 			for (const auto& [k, v] : transfers) {
 				// map type - [ TransferOperation key, tuple(end_state, transition, inverse transition) ]
 				// std::get<2>(v) {in} // std::get<1>(v) {out}
+				if (std::get<1>(v) == nullptr || std::get<2>(v) == nullptr) { // Only one half of the transfer is in the topology
+					continue;
+				}
 				const TopologyState& state_vec = *std::get<0>(v);
+				if (topology_->IsDead(state_vec)) {
+					continue;
+				}
 				std::vector<std::string> label_vec(num_of_resources_, "-");
 				label_vec[std::get<1>(v)->first] = k.name();
 				label_vec[std::get<2>(v)->first] = std::get<2>(v)->second.operation();
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <optional>
+#include <unordered_map>
+#include <cstdint>
 #include <span>
 
 #include <boost/container_hash/hash.hpp>
@@ -30,6 +32,8 @@ namespace pcs {
 		ITopology* topology_;
 
 		size_t num_of_resources_;
+		// Operation id of every recipe operation, see ResolveOperationIds
+		std::unordered_map<std::string, uint32_t> operation_ids_;
 	public:
 		Controller(const Environment* machine, ITopology* topology, const Recipe* recipe);
 		std::optional<ControllerType> Generate();
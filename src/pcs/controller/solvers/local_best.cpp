@@ -25,7 +25,8 @@
 namespace pcs {
 
 	LocalBestController::LocalBestController(const Environment* machine, ITopology* topology, const Recipe* recipe)
-		: machine_(machine), recipe_(recipe), topology_(topology), num_of_resources_(machine_->NumOfResources()), used_resources_(), list_used_resources_(), cost_(0) {}
+		: machine_(machine), recipe_(recipe), topology_(topology), num_of_resources_(machine_->NumOfResources()), operation_ids_(ResolveOperationIds(*recipe)),
+		  used_resources_(), list_used_resources_(), cost_(0) {}
 
 	void LocalBestController::SetCosts(std::optional<std::filesystem::path> path) {
 		if (path.has_value()) {
@@ -117,6 +118,10 @@ namespace pcs {
 		}
 #endif
 		
+		if (machine_->IsMinimised()) {
+			controller = OriginalStates(controller, *machine_);
+		}
+
 		/* ******************************************************************************************* /
 		  * @Hack: Visualises controller no matter what (wherever it reached) for testing purposes.
 		  *	However, doesn't affect above realisability output though
@@ -137,8 +142,9 @@ namespace pcs {
 
 		const auto& [op, input, parameters, output] = task;
 
+		uint32_t op_id = operation_ids_.at(op.name());
 		for (const auto& transition : topology_->at(*topology_state).transitions_) {
-			if (op.name() == transition.label().second.operation()) {
+			if (transition.label().second.operation_id() == op_id) {
 				bool allocate = true;
 				if (!input.empty()) {
 					allocate = plan_parts.Allocate(transition.label(), input);
@@ -161,13 +167,13 @@ namespace pcs {
 					break;
 				}
 			} else {
-				std::optional<TransferOperation> opt = StringToTransfer(transition.label().second.operation());
-				if (opt.has_value()) {
-					if (opt->IsOut()) {
-						std::get<0>(transfers[*opt]) = &(transition.to());
-						std::get<1>(transfers[*opt]) = &(transition.label());
+				if (transition.label().second.IsTransfer()) {
+					TransferOperation transfer = transition.label().second.transfer();
+					if (transfer.IsOut()) {
+						std::get<0>(transfers[transfer]) = &(transition.to());
+						std::get<1>(transfers[transfer]) = &(transition.label());
 					} else {
-						TransferOperation inverse = opt->Inverse(); // The associated map key is the inverse
+						TransferOperation inverse = transfer.Inverse(); // The associated map key is the inverse
 						std::get<2>(transfers[inverse]) = &(transition.label());
 					}
 				}
@@ -203,7 +209,13 @@ namespace pcs {
 			for (const auto& [k, v] : transfers) {
 				// map type - [ TransferOperation key, tuple(end_state, transition, inverse transition) ]
 				// std::get<2>(v) {in} // std::get<1>(v) {out}
+				if (std::get<1>(v) == nullptr || std::get<2>(v) == nullptr) { // Only one half of the transfer is in the topology
+					continue;
+				}
 				const TopologyState& state_vec = *std::get<0>(v);
+				if (topology_->IsDead(state_vec)) {
+					continue;
+				}
 				std::vector<std::string> label_vec(num_of_resources_, "-");
 				label_vec[std::get<1>(v)->first] = k.name();
 				label_vec[std::get<2>(v)->first] = std::get<2>(v)->second.operation();
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <optional>
+#include <unordered_map>
+#include <cstdint>
 #include <span>
 #include <set>
 
@@ -37,6 +39,8 @@ namespace pcs {
 		size_t num_of_resources_;		
 		MinimizeOpt opt_;
 		std::vector<double> costs_;
+		// Operation id of every recipe operation, see ResolveOperationIds
+		std::unordered_map<std::string, uint32_t> operation_ids_;
 
 		std::unordered_set<size_t> used_resources_;
 		std::list<size_t> list_used_resources_;
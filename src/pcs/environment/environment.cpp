@@ -1,7 +1,23 @@
 #include "pcs/environment/environment.h"
 
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+
 #include "pcs/topology/complete.h"
 #include "pcs/topology/incremental.h"
+#include "pcs/topology/reduced.h"
+#include "pcs/topology/symmetry.h"
+#include "pcs/topology/symbolic.h"
+#include "pcs/topology/frozen.h"
+#include "pcs/topology/snapshot.h"
+#include "pcs/topology/resource_automaton.h"
+#include "pcs/topology/influence.h"
+#include "pcs/topology/clustered.h"
+#include "pcs/topology/estimator.h"
 #include "lts/parsers/parsers.h"
 #include "pcs/common/log.h"
 
@@ -25,6 +41,80 @@ namespace pcs {
 		return resources_;
 	}
 
+	/*
+	 * @brief The compiled resources, built on first use and reused by every topology until the resources change.
+	 */
+	std::shared_ptr<const std::vector<ResourceAutomaton>> Environment::automata() {
+		if (!automata_) {
+			automata_ = Quotient(cone_ ? CompileResources(resources_, *cone_) : CompileResources(resources_));
+		}
+		return automata_;
+	}
+
+	/*
+	 * @brief Builds every following topology from the bisimulation quotients of the resources, see ResourceAutomaton::Minimise.
+	 * Topology states are named after original states and the original names of merged states are still accepted.
+	 * The solvers rename the states of the controllers they generate to the original states, see OriginalStates.
+	 */
+	void Environment::Minimise() {
+		if (!minimise_) {
+			minimise_ = true;
+			automata_.reset();
+			projections_.clear();
+		}
+	}
+
+	/*
+	 * @brief Restricts every following topology to the resources that can influence the recipe, see RelevantResources.
+	 * The other resources are held in their initial state, where they can nop, so they add no states to the topology.
+	 * The restriction holds until a resource is added.
+	 * @returns The indices of the relevant resources
+	 */
+	std::vector<size_t> Environment::ConeOfInfluence(const Recipe& recipe) {
+		std::unordered_set<uint32_t> operations;
+		for (const auto& name : recipe.Operations()) {
+			operations.emplace(ParameterizedOp::OperationId(name));
+		}
+		std::vector<size_t> relevant = RelevantResources(*CompileResources(resources_), operations);
+		PCS_INFO(fmt::format("[Cone of influence] {} of {} resources are relevant to the recipe", relevant.size(), resources_.size()));
+		if (cone_ != relevant) {
+			cone_ = relevant;
+			automata_.reset();
+		}
+		return relevant;
+	}
+
+	bool Environment::IsMinimised() const {
+		return minimise_;
+	}
+
+	/*
+	 * @brief The original state of resource reached from its original state from by a transition named operation, whose
+	 * target is in the block named to of the minimised resource the current topology was built from. Topology states
+	 * name every block after one of its states, so this recovers the states a run of the topology actually passes.
+	 * @returns to if the resources are not minimised or no such transition exists
+	 */
+	std::string Environment::OriginalSuccessor(size_t resource, const std::string& from, const std::string& operation, const std::string& to) const {
+		if (!minimise_ || !topology_automata_) {
+			return to;
+		}
+		const ResourceAutomaton& quotient = (*topology_automata_)[resource];
+		uint32_t block = quotient.Id(to);
+		for (const auto& transition : resources_[resource].states().at(from).transitions_) {
+			if (transition.label().operation() == operation && quotient.Id(transition.to()) == block) {
+				return transition.to();
+			}
+		}
+		return to;
+	}
+
+	std::shared_ptr<const std::vector<ResourceAutomaton>> Environment::Quotient(std::shared_ptr<const std::vector<ResourceAutomaton>> automata) const {
+		if (!minimise_) {
+			return automata;
+		}
+		return MinimiseResources(*automata);
+	}
+
 	const ITopology* Environment::topology() const {
 		return topology_.get();
 	}
@@ -37,16 +127,260 @@ namespace pcs {
 		return resources_.size();
 	}
 
+	/*
+	 * @brief Number of states of the current topology, see ITopology::NumOfStates
+	 */
 	size_t Environment::NumOfTopologyStates() const {
-		return topology_->lts().NumOfStates();
+		return topology_->NumOfStates();
 	}
 
-	void Environment::Complete() {
-		topology_ = std::make_unique<CompleteTopology>(resources_);
+	/*
+	 * @brief Estimates the size of the complete topology of the resources by random walks, see EstimateTopology
+	 */
+	TopologyEstimate Environment::Estimate() {
+		return EstimateTopology(automata());
+	}
+
+	/*
+	 * @brief Builds the complete topology when its estimated size fits in memory_budget, the incremental one otherwise.
+	 * @param memory_budget: @default = kTopologyMemoryBudget. Bytes the complete topology may take
+	 * @returns The strategy that was used
+	 */
+	TopologyStrategy Environment::AutoTopology(size_t memory_budget) {
+		TopologyEstimate estimate = Estimate();
+		TopologyStrategy strategy = (estimate.num_bytes <= static_cast<double>(memory_budget)) ? TopologyStrategy::complete : TopologyStrategy::incremental;
+		PCS_INFO(fmt::format("[Auto Topology] ~{:.0f} states, branching factor {:.2f}, ~{:.0f} MiB: {}", estimate.num_states,
+			estimate.branching_factor, estimate.num_bytes / (1 << 20), (strategy == TopologyStrategy::complete) ? "complete" : "incremental"));
+		if (strategy == TopologyStrategy::complete) {
+			Complete();
+		} else {
+			Incremental();
+		}
+		return strategy;
+	}
+
+	/*
+	 * @brief Screens the recipe for realisability without building a topology, by a bitstate exploration of the
+	 * resources, see BitstateExplore. Operations it does not reach are missing only with the reported probability.
+	 * @param memory_budget: @default = kBitstateMemoryBudget. Bytes of the bit array
+	 * @param max_depth: @default = kBitstateMaxDepth. Longest path the search follows, see BitstateReport::num_truncated
+	 */
+	BitstateReport Environment::Screen(const Recipe& recipe, size_t memory_budget, size_t max_depth) {
+		std::unordered_set<uint32_t> operations;
+		for (const auto& name : recipe.Operations()) {
+			operations.emplace(ParameterizedOp::OperationId(name));
+		}
+		BitstateReport report = BitstateExplore(automata(), operations, memory_budget, kBitstateNumHashes, max_depth);
+		PCS_INFO(fmt::format("[Screen] {} states, {} transitions, {} of {} operations reached, omission probability {:.2e}", report.num_states,
+			report.num_transitions, report.reached_operations.size(), operations.size(), report.omission_probability));
+		if (report.num_truncated != 0) {
+			PCS_WARN(fmt::format("[Screen] {} transitions were cut at depth {}, states beyond it may be missed", report.num_truncated, max_depth));
+		}
+		return report;
+	}
+
+	/*
+	 * @param num_threads: @default = 1. Builds the complete topology with this many threads, 0 = hardware concurrency.
+	 */
+	void Environment::Complete(size_t num_threads) {
+		topology_ = std::make_unique<CompleteTopology>(automata(), false, num_threads);
+		topology_automata_ = automata_;
 	}
 
 	void Environment::Incremental() {
-		topology_ = std::make_unique<IncrementalTopology>(resources_);
+		topology_ = std::make_unique<IncrementalTopology>(automata());
+		topology_automata_ = automata_;
+	}
+
+	/*
+	 * @brief Builds the topology restricted to the transitions a controller can realise, see ReducedTopology
+	 */
+	void Environment::Reduced() {
+		topology_ = std::make_unique<ReducedTopology>(automata());
+		topology_automata_ = automata_;
+	}
+
+	/*
+	 * @brief Builds the topology quotiented by permutations of identical resources, see SymmetricTopology
+	 */
+	void Environment::Symmetric() {
+		topology_ = std::make_unique<SymmetricTopology>(automata());
+		topology_automata_ = automata_;
+	}
+
+	/*
+	 * @brief Computes the reachable states symbolically and expands states on demand, see SymbolicTopology
+	 */
+	void Environment::Symbolic() {
+		topology_ = std::make_unique<SymbolicTopology>(automata());
+		topology_automata_ = automata_;
+	}
+
+	/*
+	 * @brief Composes the topology from the products of clusters of resources, see ClusteredTopology.
+	 * The product of a cluster is kept while the cluster's resources stay the same, so when only one cluster changes
+	 * the others are not explored again.
+	 * @param clusters: @default = empty. Partition of the resource indices, empty to group the resources that share transfers
+	 * @exception Throws std::invalid_argument if the clusters do not partition the resources
+	 */
+	void Environment::Clustered(std::vector<std::vector<size_t>> clusters) {
+		std::shared_ptr<const std::vector<ResourceAutomaton>> automata = this->automata();
+		if (clusters.empty()) {
+			clusters = TransferGroups(*automata);
+		}
+		clusters = ClusteredTopology::NormaliseClusters(std::move(clusters), automata->size());
+
+		std::map<uint64_t, std::shared_ptr<ClusterProduct>> cluster_products;
+		std::vector<std::shared_ptr<ClusterProduct>> products;
+		for (const auto& cluster : clusters) {
+			std::shared_ptr<const std::vector<ResourceAutomaton>> resources = ClusteredTopology::ClusterResources(*automata, cluster);
+			uint64_t hash = ResourcesHash(*resources);
+			auto it = cluster_products_.find(hash);
+			std::shared_ptr<ClusterProduct> product = (it != cluster_products_.end()) ? it->second : std::make_shared<ClusterProduct>(resources);
+			cluster_products.emplace(hash, product);
+			products.emplace_back(std::move(product));
+		}
+		cluster_products_ = std::move(cluster_products);
+		topology_ = std::make_shared<ClusteredTopology>(automata, std::move(clusters), std::move(products));
+		topology_automata_ = automata;
+	}
+
+	/*
+	 * @brief Computes the complete topology on disk into a snapshot and maps it, for topologies that do not fit in memory
+	 * @param memory_budget: bytes the construction may hold in its sort buffers, see BuildExternalTopology
+	 * @exception Propagates std::ofstream::failure and std::runtime_error on I/O errors
+	 */
+	void Environment::External(const std::filesystem::path& snapshot, size_t memory_budget) {
+		try {
+			BuildExternalTopology(automata(), snapshot, memory_budget);
+			topology_ = std::make_shared<MappedTopology>(snapshot, automata());
+			topology_automata_ = automata_;
+		} catch (const std::runtime_error& e) {
+			throw;
+		}
+	}
+
+	/*
+	 * @brief Builds the frozen topology partitioned over num_workers worker processes, see BuildDistributedTopology
+	 * @exception Propagates std::runtime_error if a worker cannot be started or fails
+	 */
+	void Environment::Distributed(size_t num_workers, WorkerMode mode) {
+		topology_ = BuildDistributedTopology(automata(), num_workers, mode);
+		topology_automata_ = automata_;
+	}
+
+	/*
+	 * @brief Replaces the complete topology by its immutable CSR form, see CompleteTopology::Freeze
+	 * @param checkpoint_interval: @default = 1. Stores wide states as deltas from their parent when > 1, see DeltaStateStore::Pays
+	 * @exception Throws std::logic_error if the current topology is not a complete topology
+	 */
+	void Environment::Freeze(uint32_t checkpoint_interval) {
+		CompleteTopology* complete = dynamic_cast<CompleteTopology*>(topology_.get());
+		if (complete == nullptr) {
+			throw std::logic_error("Only a complete topology can be frozen");
+		}
+		topology_ = complete->Freeze(checkpoint_interval);
+	}
+
+	/*
+	 * @brief Marks the states from which no operation of the recipe can be executed, see FrozenTopology::Prune.
+	 * A complete topology is frozen first.
+	 * @exception Throws std::logic_error if the current topology is neither complete nor frozen
+	 */
+	PruneReport Environment::Prune(const Recipe& recipe) {
+		if (dynamic_cast<CompleteTopology*>(topology_.get()) != nullptr) {
+			Freeze();
+		}
+		FrozenTopology* frozen = dynamic_cast<FrozenTopology*>(topology_.get());
+		if (frozen == nullptr) {
+			throw std::logic_error("Only a complete or frozen topology can be pruned");
+		}
+		std::unordered_set<uint32_t> operations;
+		for (const auto& name : recipe.Operations()) {
+			operations.emplace(ParameterizedOp::OperationId(name));
+		}
+		PruneReport report = frozen->Prune(operations);
+		PCS_INFO(fmt::format("[Prune] {} of {} states and {} of {} transitions are dead", report.num_dead_states, report.num_states,
+			report.num_dead_transitions, report.num_transitions));
+		return report;
+	}
+
+	/*
+	 * @brief Writes the current topology to a snapshot that LoadSnapshot can map back in, a complete topology is frozen first
+	 * @exception Throws std::logic_error if the current topology is neither complete nor frozen, propagates std::ofstream::failure
+	 */
+	void Environment::SaveSnapshot(const std::filesystem::path& path) {
+		if (const FrozenTopology* frozen = dynamic_cast<const FrozenTopology*>(topology_.get())) {
+			pcs::SaveSnapshot(*frozen, path);
+			return;
+		}
+		const CompleteTopology* complete = dynamic_cast<const CompleteTopology*>(topology_.get());
+		if (complete == nullptr) {
+			throw std::logic_error("Only a complete or frozen topology can be saved");
+		}
+		pcs::SaveSnapshot(*complete->Freeze(), path);
+	}
+
+	/*
+	 * @brief Replaces the topology by the memory-mapped snapshot, see MappedTopology
+	 * @exception Propagates std::runtime_error if the snapshot was computed from different resources or is invalid
+	 */
+	void Environment::LoadSnapshot(const std::filesystem::path& path) {
+		try {
+			topology_ = std::make_shared<MappedTopology>(path, automata());
+			topology_automata_ = automata_;
+		} catch (const std::runtime_error& e) {
+			throw;
+		}
+	}
+
+	/*
+	 * @brief File name of the snapshot of these resources, derived from their content hash
+	 */
+	std::string Environment::SnapshotName() {
+		std::ostringstream name;
+		name << "topology-" << std::hex << std::setw(16) << std::setfill('0') << ResourcesHash(*automata()) << ".pcst";
+		return name.str();
+	}
+
+	/*
+	 * @brief Builds the complete topology that is relevant to the recipe: observable transitions whose operation does
+	 * not occur in the recipe are dropped when the resources are compiled, so they are never expanded. Nops and
+	 * transfers are kept.
+	 */
+	void Environment::ComputeTopology(const Recipe& recipe) {
+		std::unordered_set<uint32_t> operations;
+		for (const auto& name : recipe.Operations()) {
+			operations.emplace(ParameterizedOp::OperationId(name));
+		}
+		topology_automata_ = Quotient(cone_ ? CompileResources(resources_, operations, *cone_) : CompileResources(resources_, operations));
+		topology_ = std::make_unique<CompleteTopology>(topology_automata_);
+	}
+
+	/*
+	 * @brief Computes the topology over a subset of the resources, the others are held in their initial state.
+	 * Under a cone of influence the resources outside the cone are held idle as well, the subset is narrowed to the cone
+	 * before the cache lookup. Projections are cached per subset until the resources change.
+	 * @exception Throws std::out_of_range if a resource index is out of range
+	 */
+	void Environment::ComputeTopology(std::initializer_list<size_t> resources) {
+		std::vector<size_t> subset(resources);
+		std::sort(subset.begin(), subset.end());
+		subset.erase(std::unique(subset.begin(), subset.end()), subset.end());
+		if (!subset.empty() && subset.back() >= resources_.size()) {
+			throw std::out_of_range("Resource index out of range");
+		}
+		if (cone_) {
+			std::erase_if(subset, [this](size_t i) { return !std::binary_search(cone_->begin(), cone_->end(), i); });
+		}
+
+		auto [it, inserted] = projections_.try_emplace(subset);
+		if (inserted) {
+			it->second.second = Quotient(CompileResources(resources_, subset));
+			it->second.first = std::make_shared<CompleteTopology>(it->second.second);
+		}
+		topology_ = it->second.first;
+		topology_automata_ = it->second.second;
 	}
 
 	/*
@@ -74,6 +408,9 @@ namespace pcs {
 	 */
 	void Environment::AddResource(const nightly::LTS<std::string, pcs::ParameterizedOp>& resource) {
 		resources_.emplace_back(resource);
+		automata_.reset();
+		projections_.clear();
+		cone_.reset();
 
 		//if (topology_.NumOfStates() == 0) {
 		//	resources_.emplace_back(resource);
@@ -87,6 +424,9 @@ namespace pcs {
 	 */
 	void Environment::AddResource(nightly::LTS<std::string, pcs::ParameterizedOp>&& resource) {
 		resources_.emplace_back(std::move(resource));
+		automata_.reset();
+		projections_.clear();
+		cone_.reset();
 
 		//if (topology_.NumOfStates() == 0) {
 		//	resources_.emplace_back(std::move(resource));
@@ -4,6 +4,9 @@
 #include <span>
 #include <filesystem>
 #include <memory>
+#include <map>
+#include <string>
+#include <optional>
 
 #include <boost/container_hash/hash.hpp>
 
@@ -12,27 +15,65 @@
 #include "pcs/topology/topology.h"
 #include "pcs/topology/complete.h"
 #include "pcs/topology/incremental.h"
+#include "pcs/topology/reduced.h"
+#include "pcs/topology/symmetry.h"
+#include "pcs/topology/frozen.h"
+#include "pcs/topology/external.h"
+#include "pcs/topology/distributed.h"
+#include "pcs/topology/clustered.h"
+#include "pcs/topology/estimator.h"
+#include "pcs/topology/bitstate.h"
+#include "pcs/topology/resource_automaton.h"
 
 namespace pcs {
 
+	enum class TopologyStrategy { complete, incremental };
+
 	class Environment {
 	private:
 		std::vector<nightly::LTS<std::string, ParameterizedOp>> resources_;
-		std::unique_ptr<ITopology> topology_;
+		std::shared_ptr<ITopology> topology_;
+		std::shared_ptr<const std::vector<ResourceAutomaton>> automata_;
+		// Resources the current topology was built from
+		std::shared_ptr<const std::vector<ResourceAutomaton>> topology_automata_;
+		// Projection topologies per subset of the resources, with the resources they were built from
+		std::map<std::vector<size_t>, std::pair<std::shared_ptr<ITopology>, std::shared_ptr<const std::vector<ResourceAutomaton>>>> projections_;
+		bool minimise_ = false;
+		std::optional<std::vector<size_t>> cone_;
+		std::map<uint64_t, std::shared_ptr<ClusterProduct>> cluster_products_;
 	public:
 		Environment() = default;
 		Environment(const std::span<nightly::LTS<std::string, ParameterizedOp>>& resources, bool compute_topology);
 		Environment(std::vector<nightly::LTS<std::string, ParameterizedOp>>&& resources, bool compute_topology);
 
 		const std::vector<nightly::LTS<std::string, ParameterizedOp>>& resources() const;
+		std::shared_ptr<const std::vector<ResourceAutomaton>> automata();
 		const ITopology* topology() const;
 	    ITopology* topology();
 
 		size_t NumOfResources() const;
 		size_t NumOfTopologyStates() const;
 
-		void Complete();
+		void Minimise();
+		bool IsMinimised() const;
+		std::string OriginalSuccessor(size_t resource, const std::string& from, const std::string& operation, const std::string& to) const;
+		std::vector<size_t> ConeOfInfluence(const Recipe& recipe);
+		TopologyEstimate Estimate();
+		TopologyStrategy AutoTopology(size_t memory_budget = kTopologyMemoryBudget);
+		BitstateReport Screen(const Recipe& recipe, size_t memory_budget = kBitstateMemoryBudget, size_t max_depth = kBitstateMaxDepth);
+		void Complete(size_t num_threads = 1);
 		void Incremental();
+		void Reduced();
+		void Symmetric();
+		void Symbolic();
+		void Clustered(std::vector<std::vector<size_t>> clusters = {});
+		void External(const std::filesystem::path& snapshot, size_t memory_budget = kExternalMemoryBudget);
+		void Distributed(size_t num_workers, WorkerMode mode = WorkerMode::process);
+		void Freeze(uint32_t checkpoint_interval = 1);
+		PruneReport Prune(const Recipe& recipe);
+		void SaveSnapshot(const std::filesystem::path& path);
+		void LoadSnapshot(const std::filesystem::path& path);
+		std::string SnapshotName();
 
 		/* @Todo */
 		void ComputeTopology(std::initializer_list<size_t> resources);
@@ -41,5 +82,7 @@ namespace pcs {
 		void AddResource(const nightly::LTS<std::string, pcs::ParameterizedOp>& resource);
 		void AddResource(nightly::LTS<std::string, pcs::ParameterizedOp>&& resource);
 		void RemoveResource();
+	private:
+		std::shared_ptr<const std::vector<ResourceAutomaton>> Quotient(std::shared_ptr<const std::vector<ResourceAutomaton>> automata) const;
 	};
 }
\ No newline at end of file
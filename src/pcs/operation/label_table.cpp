@@ -0,0 +1,125 @@
+#include "pcs/operation/label_table.h"
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <utility>
+#include <algorithm>
+
+#include "pcs/operation/parameters.h"
+#include "pcs/operation/parsers/label.h"
+
+namespace pcs {
+
+	LabelTable& LabelTable::Global() {
+		static LabelTable table;
+		return table;
+	}
+
+	/*
+	 * @brief Returns the entry of the label with a reference taken for the caller, creating and classifying it the
+	 * first time it is seen.
+	 */
+	const LabelEntry* LabelTable::Intern(const std::string& operation, const Parameters& parameters) {
+		std::string key = Key(operation, parameters);
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto [it, inserted] = index_.try_emplace(std::move(key));
+		if (!inserted) {
+			it->second->refs.fetch_add(1, std::memory_order_relaxed);
+			return it->second.get();
+		}
+
+		LabelClass label_class = ClassifyLabel(operation);
+		it->second = std::make_unique<LabelEntry>();
+		LabelEntry& entry = *it->second;
+		entry.operation = operation;
+		entry.parameters = parameters;
+		entry.kind = label_class.kind;
+		entry.transfer_type = label_class.transfer_type;
+		entry.transfer_n = label_class.transfer_n;
+		if (free_ids_.empty()) {
+			entry.id = static_cast<uint32_t>(index_.size() - 1);
+		} else {
+			entry.id = free_ids_.back();
+			free_ids_.pop_back();
+		}
+		auto [op_it, new_operation] = operations_.try_emplace(operation, Operation{ 0, 0 });
+		if (new_operation) {
+			if (free_operation_ids_.empty()) {
+				op_it->second.id = static_cast<uint32_t>(operations_.size() - 1);
+			} else {
+				op_it->second.id = free_operation_ids_.back();
+				free_operation_ids_.pop_back();
+			}
+		}
+		++op_it->second.num_labels;
+		entry.operation_id = op_it->second.id;
+		entry.refs.store(1, std::memory_order_relaxed);
+		return &entry;
+	}
+
+	/*
+	 * @brief Takes another reference to an entry the caller already holds one to
+	 */
+	void LabelTable::Retain(const LabelEntry* entry) {
+		entry->refs.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/*
+	 * @brief Drops a reference to entry and frees it with the last one. Only the last reference is dropped under the
+	 * lock, so Intern cannot hand out an entry that is being freed.
+	 */
+	void LabelTable::Release(const LabelEntry* entry) {
+		size_t refs = entry->refs.load(std::memory_order_relaxed);
+		while (refs > 1) {
+			if (entry->refs.compare_exchange_weak(refs, refs - 1, std::memory_order_acq_rel)) {
+				return;
+			}
+		}
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (entry->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+			return;
+		}
+		auto op_it = operations_.find(entry->operation);
+		if (--op_it->second.num_labels == 0) {
+			free_operation_ids_.emplace_back(op_it->second.id);
+			operations_.erase(op_it);
+		}
+		free_ids_.emplace_back(entry->id);
+		index_.erase(Key(entry->operation, entry->parameters));
+	}
+
+	/*
+	 * @brief Id of the operation name shared by every live label with that name, kUnknownOperation if there is none.
+	 * Ids of names no longer in use are given to new names, so an id is only meaningful while labels with it live.
+	 */
+	uint32_t LabelTable::OperationId(const std::string& operation) const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = operations_.find(operation);
+		return (it != operations_.end()) ? it->second.id : kUnknownOperation;
+	}
+
+	size_t LabelTable::NumOfLabels() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return index_.size();
+	}
+
+	/*
+	 * @brief Parameters are unordered, they are sorted so that equal labels always produce the same key.
+	 */
+	std::string LabelTable::Key(const std::string& operation, const Parameters& parameters) {
+		std::vector<std::pair<std::string, std::string>> sorted(parameters.map().begin(), parameters.map().end());
+		std::sort(sorted.begin(), sorted.end());
+		std::string key = operation;
+		for (const auto& [name, value] : sorted) {
+			key += '\x1f';
+			key += name;
+			key += '\x1e';
+			key += value;
+		}
+		return key;
+	}
+
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+
+#include "pcs/operation/parameters.h"
+#include "pcs/operation/transfer.h"
+
+namespace pcs {
+
+	/**
+	 * @brief: Kind of a transition label, decided once when the label is interned
+	 */
+	enum class LabelKind { observable, nop, transfer };
+
+	/**
+	 * @brief: A distinct (operation, parameters) label together with everything derived from it
+	 */
+	struct LabelEntry {
+		std::string operation;
+		Parameters parameters;
+		LabelKind kind = LabelKind::observable;
+		TransferType transfer_type = TransferType::in;
+		size_t transfer_n = 0;
+		uint32_t id = 0;
+		uint32_t operation_id = 0;
+		// Number of ParameterizedOps pointing to the entry, the entry is freed when it drops to 0
+		mutable std::atomic<size_t> refs = 0;
+	};
+
+	/**
+	 * @brief Process-wide index of the live transition labels.
+	 *
+	 * Every distinct label is stored once, so a ParameterizedOp only carries a pointer to its entry and two labels are
+	 * equal iff they point to the same entry. Entries are owned by the ParameterizedOps pointing to them: Intern and
+	 * Retain take a reference, Release drops it and the last Release frees the entry together with its ids, so the
+	 * table only holds the labels of the resources, topologies and recipes still alive. Operation names get their own
+	 * ids so that matching an operation regardless of its parameters is an integer compare as well. Interning and
+	 * releasing the last reference lock the table, copying a label does not.
+	 */
+	class LabelTable {
+	public:
+		// Operation id of names no live label has, never equal to the operation_id of an entry
+		static constexpr uint32_t kUnknownOperation = UINT32_MAX;
+	private:
+		struct Operation {
+			uint32_t id;
+			size_t num_labels;
+		};
+
+		mutable std::mutex mutex_;
+		std::unordered_map<std::string, std::unique_ptr<LabelEntry>> index_;
+		std::unordered_map<std::string, Operation> operations_;
+		std::vector<uint32_t> free_ids_;
+		std::vector<uint32_t> free_operation_ids_;
+	public:
+		static LabelTable& Global();
+
+		LabelTable(const LabelTable&) = delete;
+		LabelTable& operator=(const LabelTable&) = delete;
+
+		const LabelEntry* Intern(const std::string& operation, const Parameters& parameters);
+		static void Retain(const LabelEntry* entry);
+		void Release(const LabelEntry* entry);
+
+		uint32_t OperationId(const std::string& operation) const;
+		size_t NumOfLabels() const;
+	private:
+		LabelTable() = default;
+		static std::string Key(const std::string& operation, const Parameters& parameters);
+	};
+
+}
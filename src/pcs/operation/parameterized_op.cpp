@@ -6,66 +6,73 @@
 
 #include "pcs/operation/operation.h"
 #include "pcs/operation/parameters.h"
+#include "pcs/operation/transfer.h"
+#include "pcs/operation/label_table.h"
 
 namespace pcs {
 
+	ParameterizedOp::ParameterizedOp()
+		: ParameterizedOp(std::string(), Parameters()) {}
+
 	ParameterizedOp::ParameterizedOp(const std::string& op, const Parameters& parameters)
-		: operation_(op), parameters_(parameters) {}
+		: entry_(LabelTable::Global().Intern(op, parameters)) {}
 	
 	ParameterizedOp::ParameterizedOp(std::string&& op, Parameters&& parameters)
-		: operation_(std::move(op)), parameters_(std::move(parameters)) {}
+		: entry_(LabelTable::Global().Intern(op, parameters)) {}
 
-	ParameterizedOp::ParameterizedOp(const ParameterizedOp& other)
-		: operation_(other.operation_), parameters_(other.parameters_) {}
-	
-	ParameterizedOp& ParameterizedOp::operator=(const ParameterizedOp& other) {
-		operation_ = other.operation_;
-		parameters_ = other.parameters_;
-		return *this;
+	ParameterizedOp::~ParameterizedOp() {
+		LabelTable::Global().Release(entry_);
 	}
-	
-	ParameterizedOp::ParameterizedOp(ParameterizedOp&& other) noexcept
-		: operation_(std::move(other.operation_)), parameters_(std::move(other.parameters_)) {}
-	
-	ParameterizedOp& ParameterizedOp::operator=(ParameterizedOp&& other) noexcept {
-		operation_ = std::move(other.operation_);
-		parameters_ = std::move(other.parameters_);
-		return *this;
+
+	void ParameterizedOp::set_operation(const std::string& op) {
+		Relabel(op, entry_->parameters);
 	}
 
-	const std::string& ParameterizedOp::operation() const {
-		return operation_;
+	void ParameterizedOp::set_operation(std::string&& op) {
+		Relabel(op, entry_->parameters);
 	}
 
-	void ParameterizedOp::set_operation(const std::string& op) {
-		operation_ = op;
+	/*
+	 * @returns The id shared by the live labels of operation op, LabelTable::kUnknownOperation if there are none
+	 */
+	uint32_t ParameterizedOp::OperationId(const std::string& op) {
+		return LabelTable::Global().OperationId(op);
 	}
 
-	void ParameterizedOp::set_operation(std::string&& op) {
-		operation_ = std::move(op);
+	/*
+	 * @brief Only meaningful when IsTransfer()
+	 */
+	TransferOperation ParameterizedOp::transfer() const {
+		return TransferOperation(entry_->transfer_type, entry_->transfer_n);
 	}
 
 	const Parameters& ParameterizedOp::parameters() const {
-		return parameters_;
+		return entry_->parameters;
 	}
 
 	void ParameterizedOp::set_parameters(const Parameters& parameters) {
-		parameters_ = parameters;
+		Relabel(entry_->operation, parameters);
 	}
 
 	void ParameterizedOp::set_parameters(Parameters&& parameters) {
-		parameters_ = std::move(parameters);
+		Relabel(entry_->operation, parameters);
 	}
 
-	bool ParameterizedOp::operator==(const ParameterizedOp& other) const {
-		return (operation_ == other.operation_ && parameters_ == other.parameters_);
+	/*
+	 * @brief Points the label to the entry of (op, parameters), the old entry is released only afterwards since op or
+	 * parameters may refer to it
+	 */
+	void ParameterizedOp::Relabel(const std::string& op, const Parameters& parameters) {
+		const LabelEntry* old_entry = entry_;
+		entry_ = LabelTable::Global().Intern(op, parameters);
+		LabelTable::Global().Release(old_entry);
 	}
 
 	std::ostream& operator<<(std::ostream& os, const ParameterizedOp& p_op) {
 		os << p_op.operation();
-		if (!p_op.parameters_.empty()) {
+		if (!p_op.parameters().empty()) {
 			os << "(";
-			os << p_op.parameters_;
+			os << p_op.parameters();
 			os << ")";
 		}
 		return os;
@@ -73,9 +80,9 @@ namespace pcs {
 
 	std::ofstream& operator<<(std::ofstream& os, const ParameterizedOp& p_op) {
 		os << p_op.operation();
-		if (!p_op.parameters_.empty()) {
+		if (!p_op.parameters().empty()) {
 			os << "(<I>";
-			os << p_op.parameters_;
+			os << p_op.parameters();
 			os << "</I>)";
 		}
 		return os;
@@ -5,39 +5,101 @@
 #include <string>
 #include <ostream>
 #include <fstream>
+#include <cstdint>
 
 #include "pcs/operation/operation.h"
 #include "pcs/operation/parameters.h"
+#include "pcs/operation/transfer.h"
+#include "pcs/operation/label_table.h"
 
 namespace pcs {
 
+	/**
+	 * @brief A transition label. The operation and parameters live in the process-wide LabelTable, a ParameterizedOp
+	 * is a counted reference to its entry so copying it is cheap and equality is a pointer compare.
+	 */
 	class ParameterizedOp {
 	private:
-		std::string operation_;
-		Parameters parameters_;
+		const LabelEntry* entry_;
 	public:
-		ParameterizedOp() = default;
+		ParameterizedOp();
 		ParameterizedOp(const std::string& op, const Parameters& parameters);
 		ParameterizedOp(std::string&& op, Parameters&& parameters);
 
-		ParameterizedOp(const ParameterizedOp& other);
-		ParameterizedOp& operator=(const ParameterizedOp& other);
-		ParameterizedOp(ParameterizedOp&& other) noexcept;
-		ParameterizedOp& operator=(ParameterizedOp&& other) noexcept;
+		ParameterizedOp(const ParameterizedOp& other) noexcept : entry_(other.entry_) {
+			LabelTable::Retain(entry_);
+		}
+
+		ParameterizedOp& operator=(const ParameterizedOp& other) {
+			LabelTable::Retain(other.entry_);
+			LabelTable::Global().Release(entry_);
+			entry_ = other.entry_;
+			return *this;
+		}
+
+		~ParameterizedOp();
+
+		const std::string& operation() const {
+			return entry_->operation;
+		}
 
-		const std::string& operation() const;
 		void set_operation(const std::string& op);
 		void set_operation(std::string&& op);
 
+		/*
+		 * @brief Id of the label in the LabelTable, equal labels have equal ids
+		 */
+		uint32_t id() const {
+			return entry_->id;
+		}
+
+		/*
+		 * @brief Id of the operation name regardless of the parameters, see LabelTable::OperationId
+		 */
+		uint32_t operation_id() const {
+			return entry_->operation_id;
+		}
+
+		static uint32_t OperationId(const std::string& op);
+
+		LabelKind kind() const {
+			return entry_->kind;
+		}
+
+		bool IsNop() const {
+			return entry_->kind == LabelKind::nop;
+		}
+
+		bool IsTransfer() const {
+			return entry_->kind == LabelKind::transfer;
+		}
+
+		bool IsObservable() const {
+			return entry_->kind == LabelKind::observable;
+		}
+
+		TransferType transfer_type() const {
+			return entry_->transfer_type;
+		}
+
+		size_t transfer_n() const {
+			return entry_->transfer_n;
+		}
+
+		TransferOperation transfer() const;
+
 		const Parameters& parameters() const;
 		void set_parameters(const Parameters& parameters);
 		void set_parameters(Parameters&& parameters);
 
-		bool operator==(const ParameterizedOp& other) const;
+		bool operator==(const ParameterizedOp& other) const {
+			return entry_ == other.entry_;
+		}
 
 		friend std::ostream& operator<<(std::ostream& os, const ParameterizedOp& p_op);
 		friend std::ofstream& operator<<(std::ofstream& os, const ParameterizedOp& p_op);
-
+	private:
+		void Relabel(const std::string& op, const Parameters& parameters);
 	};
 
 }
\ No newline at end of file
@@ -1,8 +1,11 @@
 #include "pcs/operation/parsers/label.h"
 
 #include <string>
+#include <string_view>
 #include <memory>
 #include <optional>
+#include <charconv>
+#include <system_error>
 
 #include "pcs/operation/observable.h"
 #include "pcs/operation/transfer.h"
@@ -10,22 +13,56 @@
 
 namespace pcs {
 
-	std::unique_ptr<IOperation> StringToOperation(const std::string& label) {
-		if (label.find("in:") != std::string::npos) {
-			return std::make_unique<TransferOperation>(TransferType::in, stoull(label.substr(3)));
-		} else if (label.find("out:") != std::string::npos) {
-			return std::make_unique<TransferOperation>(TransferType::out, stoull(label.substr(4)));
+	namespace {
+
+		/*
+		 * @brief The n of a label that is exactly prefix followed by a decimal number, nothing otherwise
+		 */
+		std::optional<size_t> TransferNumber(std::string_view label, std::string_view prefix) {
+			if (!label.starts_with(prefix) || label.size() == prefix.size()) {
+				return {};
+			}
+			size_t n = 0;
+			const char* last = label.data() + label.size();
+			auto [end, error] = std::from_chars(label.data() + prefix.size(), last, n);
+			if (error != std::errc() || end != last) {
+				return {};
+			}
+			return n;
+		}
+
+	}
+
+	/*
+	 * @brief Single place where the textual form of a label decides its kind: "in:n" and "out:n" are transfers,
+	 * "nop" is a nop and everything else is an observable operation. Never throws, a label that only resembles a
+	 * transfer (e.g. "login:x" or "in:x") is an observable operation.
+	 */
+	LabelClass ClassifyLabel(const std::string& label) {
+		if (std::optional<size_t> in = TransferNumber(label, "in:")) {
+			return { LabelKind::transfer, TransferType::in, *in };
+		} else if (std::optional<size_t> out = TransferNumber(label, "out:")) {
+			return { LabelKind::transfer, TransferType::out, *out };
 		} else if (label == "nop") {
+			return { LabelKind::nop };
+		}
+		return {};
+	}
+
+	std::unique_ptr<IOperation> StringToOperation(const std::string& label) {
+		LabelClass label_class = ClassifyLabel(label);
+		if (label_class.kind == LabelKind::transfer) {
+			return std::make_unique<TransferOperation>(label_class.transfer_type, label_class.transfer_n);
+		} else if (label_class.kind == LabelKind::nop) {
 			return std::make_unique<Nop>();
 		}
 		return std::make_unique<Observable>(label);
 	}
 
 	std::optional<TransferOperation> StringToTransfer(const std::string& label) {
-		if (label.find("in:") != std::string::npos) {
-			return TransferOperation(TransferType::in, stoull(label.substr(3)));
-		} else if (label.find("out:") != std::string::npos) {
-			return TransferOperation(TransferType::out, stoull(label.substr(4)));
+		LabelClass label_class = ClassifyLabel(label);
+		if (label_class.kind == LabelKind::transfer) {
+			return TransferOperation(label_class.transfer_type, label_class.transfer_n);
 		}
 		return {};
 	}
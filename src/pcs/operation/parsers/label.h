@@ -7,9 +7,18 @@
 #include "pcs/operation/operation.h"
 #include "pcs/operation/nop.h"
 #include "pcs/operation/transfer.h"
+#include "pcs/operation/label_table.h"
 
 namespace pcs {
 
+	struct LabelClass {
+		LabelKind kind = LabelKind::observable;
+		TransferType transfer_type = TransferType::in;
+		size_t transfer_n = 0;
+	};
+
+	LabelClass ClassifyLabel(const std::string& label);
+
 	std::unique_ptr<IOperation> StringToOperation(const std::string& label);
 	std::optional<TransferOperation> StringToTransfer(const std::string& label);
 }
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include "pcs/product/recipe.h"
 
+#include <string>
+#include <unordered_set>
+
 #include "pcs/product/parsers/recipe.h"
 
 namespace pcs {
@@ -33,6 +36,28 @@ namespace pcs {
 		}
 	}
 
+	/*
+	 * @brief Names of every observable operation the recipe refers to: guards, sequential and parallel tasks.
+	 */
+	std::unordered_set<std::string> Recipe::Operations() const {
+		std::unordered_set<std::string> operations;
+		for (const auto& [key, state] : lts_.states()) {
+			for (const auto& transition : state.transitions_) {
+				const CompositeOperation& co = transition.label();
+				if (co.HasGuard()) {
+					operations.emplace(co.guard.operation().name());
+				}
+				for (const auto& task : co.sequential) {
+					operations.emplace(task.operation().name());
+				}
+				for (const auto& task : co.parallel) {
+					operations.emplace(task.operation().name());
+				}
+			}
+		}
+		return operations;
+	}
+
 	Recipe::operator const nightly::LTS<std::string, CompositeOperation>& () const {
 		return lts_;
 	}
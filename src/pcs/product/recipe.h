@@ -1,7 +1,9 @@
 #pragma once
 
 #include <vector>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "lts/lts.h"
 #include "pcs/operation/composite.h"
@@ -19,6 +21,8 @@ namespace pcs {
 		const nightly::LTS<std::string, CompositeOperation>& lts() const;
 		void set_recipe(const std::filesystem::path& filepath);
 
+		std::unordered_set<std::string> Operations() const;
+
 		operator const nightly::LTS<std::string, CompositeOperation>& () const;
 
 	};
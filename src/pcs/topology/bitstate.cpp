@@ -0,0 +1,140 @@
+#include "pcs/topology/bitstate.h"
+
+#include <vector>
+#include <memory>
+#include <deque>
+#include <iterator>
+#include <cmath>
+#include <algorithm>
+#include <unordered_set>
+
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/successors.h"
+#include "pcs/topology/resource_automaton.h"
+
+namespace pcs {
+
+	namespace {
+
+		/*
+		 * @brief Visited set of a bitstate search: a state is visited when all of its num_hashes bits are set.
+		 * The bit positions come from double hashing of two independent 64 bit hashes of the state.
+		 */
+		class BitArray {
+		private:
+			std::vector<uint64_t> words_;
+			uint64_t num_bits_;
+			size_t num_hashes_;
+		public:
+			BitArray(size_t num_bytes, size_t num_hashes)
+				: words_(std::max<size_t>(num_bytes / sizeof(uint64_t), 1), 0), num_bits_(words_.size() * 64), num_hashes_(num_hashes) {}
+
+			uint64_t NumOfBits() const {
+				return num_bits_;
+			}
+
+			/*
+			 * @returns Whether some bit of state was still clear, i.e. the state is new for the search
+			 */
+			bool Insert(const PackedState& state) {
+				uint64_t h1 = state.Hash();
+				uint64_t h2 = h1 + 0x9E3779B97F4A7C15ull;
+				h2 = (h2 ^ (h2 >> 30)) * 0xBF58476D1CE4E5B9ull;
+				h2 = (h2 ^ (h2 >> 27)) * 0x94D049BB133111EBull;
+				h2 = (h2 ^ (h2 >> 31)) | 1;
+				bool inserted = false;
+				for (size_t k = 0; k < num_hashes_; ++k) {
+					uint64_t bit = (h1 + k * h2) % num_bits_;
+					uint64_t mask = uint64_t(1) << (bit & 63);
+					inserted |= (words_[bit >> 6] & mask) == 0;
+					words_[bit >> 6] |= mask;
+				}
+				return inserted;
+			}
+		};
+
+	}
+
+	/*
+	 * @brief Explores the product of the resources with a bitstate visited set in the style of Spin's supertrace: each
+	 * state costs num_hashes bits of a fixed array of memory_budget bytes instead of being stored, so far larger
+	 * topologies fit, at the price of skipping states whose bits were all set by others.
+	 *
+	 * The search is depth-first and keeps one state and one successor iterator per level of the current path. Like Spin
+	 * it bounds the path at max_depth, so memory is the bit array plus at most max_depth + 1 levels. Successors of a state
+	 * at the bound are not followed and are not marked visited, so a shorter path can still reach them; the report counts
+	 * them in num_truncated, and a search with truncations may have missed states beyond the bound.
+	 *
+	 * With n states stored the chance that a new state is taken for a visited one is (1 - e^(-kn/m))^k for k hashes and m
+	 * bits; the report gives it at the end of the search and summed over the search as the expected number of omitted
+	 * states. Meant for screening: a reached operation is certainly reachable, an unreached one is only likely unreachable.
+	 * @param memory_budget: @default = kBitstateMemoryBudget. Bytes of the bit array, the search stack is not included
+	 * @param num_hashes: @default = kBitstateNumHashes. Bits set per state
+	 * @param max_depth: @default = kBitstateMaxDepth. Longest path from the initial state the search follows
+	 */
+	BitstateReport BitstateExplore(std::shared_ptr<const std::vector<ResourceAutomaton>> automata, const std::unordered_set<uint32_t>& operations,
+		                           size_t memory_budget, size_t num_hashes, size_t max_depth) {
+		struct Level {
+			PackedState state;
+			SuccessorGenerator::Iterator successor;
+			size_t num_busy = 0;
+			size_t busy = 0;
+		};
+
+		SuccessorGenerator generator(automata);
+		BitArray visited(memory_budget, std::max<size_t>(num_hashes, 1));
+		BitstateReport report;
+		report.num_bits = visited.NumOfBits();
+		report.num_hashes = std::max<size_t>(num_hashes, 1);
+		const double k = static_cast<double>(report.num_hashes);
+		const double m = static_cast<double>(report.num_bits);
+		auto omission = [k, m](size_t num_states) {
+			return std::pow(1 - std::exp(-k * static_cast<double>(num_states) / m), k);
+		};
+
+		// A deque keeps the state of every level in place, which its successor iterator points to
+		std::deque<Level> path;
+		auto push = [&](const PackedState& state) {
+			Level& level = path.emplace_back();
+			level.state = state;
+			for (size_t i = 0; i < automata->size(); ++i) {
+				if (!(*automata)[i].HasNop(generator.codec().Get(level.state, i))) {
+					++level.num_busy;
+					level.busy = i;
+				}
+			}
+			level.successor = generator.Successors(level.state).begin();
+		};
+
+		visited.Insert(generator.initial_state());
+		push(generator.initial_state());
+		report.num_states = 1;
+		while (!path.empty()) {
+			Level& level = path.back();
+			if (level.successor == std::default_sentinel) {
+				path.pop_back();
+				continue;
+			}
+			const Successor& successor = *level.successor;
+			++report.num_transitions;
+			const ParameterizedOp& label = *successor.label;
+			if (level.num_busy <= 1 && (level.num_busy == 0 || successor.resource == level.busy) && label.IsObservable() &&
+				operations.contains(label.operation_id())) {
+				report.reached_operations.emplace(label.operation_id());
+			}
+			PackedState next = successor.state;
+			++level.successor;
+			if (path.size() > max_depth) {
+				++report.num_truncated;
+			} else if (visited.Insert(next)) {
+				report.expected_omissions += omission(report.num_states);
+				++report.num_states;
+				push(next);
+				report.depth = std::max(report.depth, path.size() - 1);
+			}
+		}
+		report.omission_probability = omission(report.num_states);
+		return report;
+	}
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <unordered_set>
+#include <cstdint>
+
+#include "pcs/topology/resource_automaton.h"
+
+namespace pcs {
+
+	inline constexpr size_t kBitstateMemoryBudget = size_t(64) << 20;
+	// Bits set per state
+	inline constexpr size_t kBitstateNumHashes = 3;
+	// Spin's default search depth bound (-m)
+	inline constexpr size_t kBitstateMaxDepth = 10000;
+
+	/*
+	 * @brief: Outcome of BitstateExplore
+	 */
+	struct BitstateReport {
+		size_t num_states = 0;
+		size_t num_transitions = 0;
+		size_t num_bits = 0;
+		size_t num_hashes = 0;
+		// Deepest path from the initial state the search followed
+		size_t depth = 0;
+		// Transitions to new states that were not followed because the search was at its depth bound
+		size_t num_truncated = 0;
+		// Probability that a state not visited yet would be taken for a visited one when exploration ended
+		double omission_probability = 0;
+		// Expected number of reachable states that were skipped as false positives
+		double expected_omissions = 0;
+		// Operations of the set that some explored state can execute, see FrozenTopology::Prune for the goal condition
+		std::unordered_set<uint32_t> reached_operations;
+	};
+
+	BitstateReport BitstateExplore(std::shared_ptr<const std::vector<ResourceAutomaton>> automata, const std::unordered_set<uint32_t>& operations,
+		                           size_t memory_budget = kBitstateMemoryBudget, size_t num_hashes = kBitstateNumHashes, size_t max_depth = kBitstateMaxDepth);
+
+}
@@ -0,0 +1,238 @@
+#include "pcs/topology/clustered.h"
+
+#include <vector>
+#include <string>
+#include <span>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+#include "lts/lts.h"
+#include "pcs/topology/influence.h"
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/packed_state_set.h"
+#include "pcs/topology/state_codec.h"
+#include "pcs/topology/transfer_index.h"
+#include "pcs/topology/resource_automaton.h"
+
+namespace pcs {
+
+	ClusterProduct::ClusterProduct(std::shared_ptr<const std::vector<ResourceAutomaton>> automata)
+		: automata_(std::move(automata)), codec_(automata_) {}
+
+	const std::vector<ResourceAutomaton>& ClusterProduct::automata() const {
+		return *automata_;
+	}
+
+	size_t ClusterProduct::NumOfStates() const {
+		return states_.size();
+	}
+
+	uint32_t ClusterProduct::Intern(std::span<const uint32_t> local_states) {
+		return Intern(codec_.Encode(local_states));
+	}
+
+	uint32_t ClusterProduct::Intern(PackedState&& state) {
+		auto [it, inserted] = ids_.try_emplace(state, static_cast<uint32_t>(states_.size()));
+		if (inserted) {
+			states_.emplace_back(std::move(state));
+			moves_.emplace_back();
+			expanded_.emplace_back(0);
+		}
+		return it->second;
+	}
+
+	/*
+	 * @brief The state with resource set to local_state and every other resource of the cluster as in state
+	 */
+	uint32_t ClusterProduct::Move(uint32_t state, size_t resource, uint32_t local_state) {
+		PackedState next = states_[state];
+		codec_.Set(next, resource, local_state);
+		return Intern(std::move(next));
+	}
+
+	/*
+	 * @brief Target state of every outgoing transition of every resource of the cluster, in (resource, transition) order
+	 */
+	std::span<const uint32_t> ClusterProduct::Moves(uint32_t state) {
+		if (expanded_[state] == 0) {
+			std::vector<uint32_t> moves;
+			for (size_t r = 0; r < automata_->size(); ++r) {
+				for (uint32_t target : (*automata_)[r].targets(Local(state, r))) {
+					moves.emplace_back(Move(state, r, target));
+				}
+			}
+			moves_[state] = std::move(moves);
+			expanded_[state] = 1;
+		}
+		return moves_[state];
+	}
+
+	ClusteredTopology::ClusteredTopology(std::shared_ptr<const std::vector<ResourceAutomaton>> automata)
+		: ClusteredTopology(automata, TransferGroups(*automata)) {}
+
+	ClusteredTopology::ClusteredTopology(std::shared_ptr<const std::vector<ResourceAutomaton>> automata, std::vector<std::vector<size_t>> clusters)
+		: ClusteredTopology(automata, NormaliseClusters(std::move(clusters), automata->size()), {}) {}
+
+	/*
+	 * @param products: @default = empty. Product of every cluster, in the order of the normalised clusters. Missing
+	 * products are created, the given ones must have been built for the same resources.
+	 * @exception Throws std::invalid_argument if the clusters do not partition the resources
+	 */
+	ClusteredTopology::ClusteredTopology(std::shared_ptr<const std::vector<ResourceAutomaton>> automata, std::vector<std::vector<size_t>> clusters,
+		                                 std::vector<std::shared_ptr<ClusterProduct>> products)
+		: automata_(std::move(automata)), transfer_index_(*automata_), clusters_(NormaliseClusters(std::move(clusters), automata_->size())),
+		  products_(std::move(products)) {
+		if (!products_.empty() && products_.size() != clusters_.size()) {
+			throw std::invalid_argument("Expected one product per cluster");
+		}
+		products_.resize(clusters_.size());
+		cluster_of_.resize(automata_->size());
+		position_.resize(automata_->size());
+		for (size_t c = 0; c < clusters_.size(); ++c) {
+			if (!products_[c]) {
+				products_[c] = std::make_shared<ClusterProduct>(ClusterResources(*automata_, clusters_[c]));
+			}
+			for (size_t r = 0; r < clusters_[c].size(); ++r) {
+				cluster_of_[clusters_[c][r]] = c;
+				position_[clusters_[c][r]] = r;
+			}
+		}
+
+		std::vector<uint32_t> initial_state;
+		for (size_t c = 0; c < clusters_.size(); ++c) {
+			std::vector<uint32_t> local_states(clusters_[c].size(), 0);
+			initial_state.emplace_back(products_[c]->Intern(local_states));
+		}
+		topology_.set_initial_state(Names(initial_state));
+	}
+
+	const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& ClusteredTopology::lts() const {
+		return topology_;
+	}
+
+	ClusteredTopology::operator const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& () const {
+		return topology_;
+	}
+
+	const std::vector<std::string>& ClusteredTopology::initial_state() const {
+		return topology_.initial_state();
+	}
+
+	const std::vector<std::vector<size_t>>& ClusteredTopology::clusters() const {
+		return clusters_;
+	}
+
+	const std::vector<std::shared_ptr<ClusterProduct>>& ClusteredTopology::products() const {
+		return products_;
+	}
+
+	/*
+	 * @brief Composes the moves of the clusters at key. Resources are visited in ascending order, so the moves of each
+	 * cluster are consumed in the order ClusterProduct::Moves lists them.
+	 */
+	const nightly::State<std::vector<std::string>, std::pair<size_t, ParameterizedOp>>& ClusteredTopology::at(const std::vector<std::string>& key) {
+		std::vector<uint32_t> state(clusters_.size());
+		for (size_t c = 0; c < clusters_.size(); ++c) {
+			std::vector<uint32_t> local_states;
+			local_states.reserve(clusters_[c].size());
+			for (size_t i : clusters_[c]) {
+				local_states.emplace_back((*automata_)[i].Id(key[i]));
+			}
+			state[c] = products_[c]->Intern(local_states);
+		}
+		PackedState packed((clusters_.size() + 1) / 2);
+		for (size_t c = 0; c < clusters_.size(); ++c) {
+			packed.set_word(c / 2, packed.word(c / 2) | (static_cast<uint64_t>(state[c]) << (32 * (c % 2))));
+		}
+		if (visited_.Contains(packed)) {
+			return topology_.states().at(key);
+		}
+
+		std::vector<std::span<const uint32_t>> moves(clusters_.size());
+		std::vector<size_t> cursors(clusters_.size(), 0);
+		for (size_t c = 0; c < clusters_.size(); ++c) {
+			moves[c] = products_[c]->Moves(state[c]);
+		}
+		for (size_t i = 0; i < automata_->size(); ++i) {
+			const size_t c = cluster_of_[i];
+			const ResourceAutomaton& automaton = (*automata_)[i];
+			std::span<const ParameterizedOp> labels = automaton.labels(products_[c]->Local(state[c], position_[i]));
+			for (size_t t = 0; t < labels.size(); ++t) {
+				std::vector<uint32_t> next = state;
+				next[c] = moves[c][cursors[c]++];
+				if (labels[t].IsTransfer()) {
+					// Same partner as MatchingTransferPartner: the lowest other resource offering the inverse transfer
+					TransferType inverse = (labels[t].transfer_type() == TransferType::in) ? TransferType::out : TransferType::in;
+					size_t n = labels[t].transfer_n();
+					std::optional<uint32_t> partner_target;
+					size_t partner = 0;
+					for (size_t j : transfer_index_.Resources(inverse, n)) {
+						if (j == i) {
+							continue;
+						}
+						partner_target = transfer_index_.Target(j, products_[cluster_of_[j]]->Local(state[cluster_of_[j]], position_[j]), inverse, n);
+						if (partner_target.has_value()) {
+							partner = j;
+							break;
+						}
+					}
+					if (!partner_target.has_value()) {
+						continue;
+					}
+					next[cluster_of_[partner]] = products_[cluster_of_[partner]]->Move(next[cluster_of_[partner]], position_[partner], *partner_target);
+				}
+				topology_.AddTransition(key, std::make_pair(i, labels[t]), Names(next));
+			}
+		}
+		visited_.Insert(packed);
+		return topology_.states().at(key);
+	}
+
+	std::vector<std::string> ClusteredTopology::Names(const std::vector<uint32_t>& state) const {
+		std::vector<std::string> names(automata_->size());
+		for (size_t i = 0; i < automata_->size(); ++i) {
+			names[i] = (*automata_)[i].Name(products_[cluster_of_[i]]->Local(state[cluster_of_[i]], position_[i]));
+		}
+		return names;
+	}
+
+	/*
+	 * @brief Sorts every cluster and orders the clusters by their lowest resource, empty clusters are dropped.
+	 * @exception Throws std::invalid_argument if the clusters do not partition [0, num_resources)
+	 */
+	std::vector<std::vector<size_t>> ClusteredTopology::NormaliseClusters(std::vector<std::vector<size_t>> clusters, size_t num_resources) {
+		std::vector<uint8_t> seen(num_resources, 0);
+		for (auto& cluster : clusters) {
+			std::sort(cluster.begin(), cluster.end());
+			for (size_t i : cluster) {
+				if (i >= num_resources || seen[i] != 0) {
+					throw std::invalid_argument("Clusters must partition the resources");
+				}
+				seen[i] = 1;
+			}
+		}
+		if (std::find(seen.begin(), seen.end(), 0) != seen.end()) {
+			throw std::invalid_argument("Clusters must partition the resources");
+		}
+		std::erase_if(clusters, [](const std::vector<size_t>& cluster) { return cluster.empty(); });
+		std::sort(clusters.begin(), clusters.end());
+		return clusters;
+	}
+
+	/*
+	 * @brief Copies of the compiled resources of a cluster, in the order of the cluster
+	 */
+	std::shared_ptr<const std::vector<ResourceAutomaton>> ClusteredTopology::ClusterResources(const std::vector<ResourceAutomaton>& automata,
+		                                                                                      const std::vector<size_t>& cluster) {
+		auto resources = std::make_shared<std::vector<ResourceAutomaton>>();
+		resources->reserve(cluster.size());
+		for (size_t i : cluster) {
+			resources->emplace_back(automata[i]);
+		}
+		return resources;
+	}
+
+}
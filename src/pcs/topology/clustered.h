@@ -0,0 +1,100 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <span>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <cstdint>
+
+#include <boost/container_hash/hash.hpp>
+
+#include "lts/lts.h"
+#include "pcs/topology/topology.h"
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/packed_state_set.h"
+#include "pcs/topology/state_codec.h"
+#include "pcs/topology/transfer_index.h"
+#include "pcs/topology/resource_automaton.h"
+
+namespace pcs {
+
+	/**
+	 * @brief Lazily explored product of one cluster of resources.
+	 *
+	 * States are packed states over the resources of the cluster, interned to dense ids. For every state the local
+	 * moves are computed once: for each resource of the cluster and each of its outgoing transitions, the state with
+	 * only that resource moved. A transfer is stored with only its initiating resource moved, the partner is resolved
+	 * when the clusters are composed. The product does not depend on the other clusters, so it can be shared by every
+	 * topology that contains the same cluster.
+	 */
+	class ClusterProduct {
+	private:
+		std::shared_ptr<const std::vector<ResourceAutomaton>> automata_;
+		StateCodec codec_;
+		std::unordered_map<PackedState, uint32_t, PackedStateHash> ids_;
+		std::vector<PackedState> states_;
+		// Per state, the target of every local transition in (resource, transition) order, empty until first asked
+		std::vector<std::vector<uint32_t>> moves_;
+		std::vector<uint8_t> expanded_;
+	public:
+		ClusterProduct(std::shared_ptr<const std::vector<ResourceAutomaton>> automata);
+
+		const std::vector<ResourceAutomaton>& automata() const;
+		size_t NumOfStates() const;
+
+		uint32_t Intern(std::span<const uint32_t> local_states);
+		std::span<const uint32_t> Moves(uint32_t state);
+		uint32_t Move(uint32_t state, size_t resource, uint32_t local_state);
+
+		uint32_t Local(uint32_t state, size_t resource) const {
+			return codec_.Get(states_[state], resource);
+		}
+	private:
+		uint32_t Intern(PackedState&& state);
+	};
+
+	/**
+	 * @brief Topology composed from the products of disjoint clusters of resources.
+	 *
+	 * A topology state is a tuple of cluster states. Moves inside a cluster come from its ClusterProduct, only transfers
+	 * are composed across clusters, with the partner MatchingTransfer would pick on the full state, so at() gives the
+	 * same transitions as CompleteTopology. States are expanded on demand like IncrementalTopology and lts() holds the
+	 * states expanded so far. Without clusters given, every group of resources that synchronise on transfers (see
+	 * TransferGroups) is a cluster.
+	 */
+	class ClusteredTopology : public ITopology {
+	private:
+		nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>> topology_;
+		// Expanded tuples of cluster states, packed two cluster states per word
+		PackedStateSet visited_;
+		std::shared_ptr<const std::vector<ResourceAutomaton>> automata_;
+		TransferIndex transfer_index_;
+
+		std::vector<std::vector<size_t>> clusters_;
+		std::vector<std::shared_ptr<ClusterProduct>> products_;
+		// Cluster of every resource and its position in that cluster
+		std::vector<size_t> cluster_of_;
+		std::vector<size_t> position_;
+	public:
+		ClusteredTopology(std::shared_ptr<const std::vector<ResourceAutomaton>> automata);
+		ClusteredTopology(std::shared_ptr<const std::vector<ResourceAutomaton>> automata, std::vector<std::vector<size_t>> clusters);
+		ClusteredTopology(std::shared_ptr<const std::vector<ResourceAutomaton>> automata, std::vector<std::vector<size_t>> clusters,
+			              std::vector<std::shared_ptr<ClusterProduct>> products);
+		const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& lts() const override;
+		operator const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& () const override;
+		const std::vector<std::string>& initial_state() const override;
+		const nightly::State<std::vector<std::string>, std::pair<size_t, ParameterizedOp>>& at(const std::vector<std::string>& key) override;
+
+		const std::vector<std::vector<size_t>>& clusters() const;
+		const std::vector<std::shared_ptr<ClusterProduct>>& products() const;
+
+		static std::vector<std::vector<size_t>> NormaliseClusters(std::vector<std::vector<size_t>> clusters, size_t num_resources);
+		static std::shared_ptr<const std::vector<ResourceAutomaton>> ClusterResources(const std::vector<ResourceAutomaton>& automata,
+			                                                                         const std::vector<size_t>& cluster);
+	private:
+		std::vector<std::string> Names(const std::vector<uint32_t>& state) const;
+	};
+
+}
@@ -4,15 +4,28 @@
 #include <vector>
 #include <span>
 #include <set>
+#include <algorithm>
 #include <utility>
 #include <unordered_set>
 #include <stack>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
 
 #include <boost/container_hash/hash.hpp>
 
 #include "lts/lts.h"
 #include "pcs/topology/topology.h"
 #include "pcs/topology/core.h"
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/state_codec.h"
+#include "pcs/topology/direct_index.h"
+#include "pcs/topology/transfer_index.h"
+#include "pcs/topology/resource_automaton.h"
+#include "pcs/topology/frozen.h"
 #include "lts/state.h"
 #include "pcs/operation/parsers/label.h"
 #include "pcs/common/log.h"
@@ -21,20 +34,37 @@ namespace pcs {
 
 	/*
 	 * @param ltss: the LTSs to merge
-	 * @param recursive: @default = true. Iterative or recursive DFS.
+	 * @param recursive: @default = false. Iterative or recursive DFS.
+	 * @param num_threads: @default = 1. Values above 1 build the topology in parallel (recursive is then ignored),
+	 * 0 uses the hardware concurrency.
 	 */
-	CompleteTopology::CompleteTopology(const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss, bool recursive)
-		: ltss_(ltss) {
-		std::vector<std::string> initial_key;
-		initial_key.reserve(ltss.size());
-		for (const auto& lts : ltss) {
-			initial_key.emplace_back(lts.initial_state());
+	CompleteTopology::CompleteTopology(const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss, bool recursive, size_t num_threads)
+		: CompleteTopology(CompileResources(ltss), recursive, num_threads) {}
+
+	/*
+	 * @param automata: the compiled resources to merge, see CompileResources
+	 *
+	 * Exploration works on PackedStates (local state ids of the compiled resources), names are only rendered for the resulting LTS.
+	 * When the product of the resources fits DirectStateIndex::kDirectAddressLimit the visited set is a bitmap over it.
+	 */
+	CompleteTopology::CompleteTopology(std::shared_ptr<const std::vector<ResourceAutomaton>> automata, bool recursive, size_t num_threads)
+		: automata_(std::move(automata)), codec_(automata_), transfer_index_(*automata_) {
+		if (DirectStateIndex::Fits(codec_)) {
+			direct_.emplace(codec_);
 		}
-		topology_.set_initial_state(initial_key);
-		if (recursive) {
-			CombineRecursive(initial_key);
+		// Local state id 0 is the initial state of every resource
+		PackedState initial_packed(codec_.NumOfWords());
+		topology_.set_initial_state(codec_.Names(initial_packed));
+		keys_.emplace(initial_packed, &topology_.states().find(topology_.initial_state())->first);
+		if (num_threads == 0) {
+			num_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		}
+		if (num_threads > 1) {
+			CombineParallel(initial_packed, num_threads);
+		} else if (recursive) {
+			CombineRecursive(initial_packed);
 		} else {
-			CombineIterative(initial_key); // ...
+			CombineIterative(initial_packed); // ...
 		}
 	}
 
@@ -54,64 +84,278 @@ namespace pcs {
 		return topology_.states().at(key);
 	}
 
-	void CompleteTopology::CombineRecursive(std::vector<std::string>& states_vec) {
-		if (visited_.contains(states_vec) == true) {
+	/*
+	 * @returns Whether key was not visited yet
+	 */
+	bool CompleteTopology::Visit(const PackedState& key) {
+		if (direct_.has_value()) {
+			return direct_->Insert(key);
+		}
+		return visited_.Insert(key);
+	}
+
+	/*
+	 * @brief Adds edge to topology_. The names of a state are only rendered the first time it is added, later edges
+	 * pass the key topology_ stored for it.
+	 */
+	void CompleteTopology::AddEdge(const PackedState& from, const Edge& edge) {
+		auto from_it = keys_.find(from);
+		auto to_it = keys_.find(edge.to);
+		if (from_it != keys_.end() && to_it != keys_.end()) {
+			topology_.AddTransition(*from_it->second, std::make_pair(edge.resource, *edge.label), *to_it->second);
+			return;
+		}
+		std::vector<std::string> from_names = (from_it != keys_.end()) ? *from_it->second : codec_.Names(from);
+		std::vector<std::string> to_names = (to_it != keys_.end()) ? *to_it->second : codec_.Names(edge.to);
+		topology_.AddTransition(from_names, std::make_pair(edge.resource, *edge.label), to_names);
+		if (from_it == keys_.end()) {
+			keys_.emplace(from, &topology_.states().find(from_names)->first);
+		}
+		if (to_it == keys_.end()) {
+			keys_.emplace(edge.to, &topology_.states().find(to_names)->first);
+		}
+	}
+
+	/*
+	 * @brief Re-numbers the states of topology_ in BFS order from the initial state and packs every edge as a
+	 * (resource, label id, target id) triple. Equal labels are stored once in the label table of the frozen topology.
+	 * Reads the transitions already in topology_, so the product is not expanded a second time.
+	 * @param checkpoint_interval: @default = 1. Stores wide states as deltas when > 1, see DeltaStateStore::Pays
+	 */
+	std::unique_ptr<FrozenTopology> CompleteTopology::Freeze(uint32_t checkpoint_interval) const {
+		// Keys of the states in id order, pointing at the keys stored in topology_
+		std::vector<const std::vector<std::string>*> names;
+		std::unordered_map<const std::vector<std::string>*, uint32_t> ids;
+		std::vector<PackedState> keys;
+		std::vector<uint64_t> offsets;
+		std::vector<FrozenTopology::Edge> frozen_edges;
+		std::vector<ParameterizedOp> labels;
+		std::unordered_map<uint32_t, uint32_t> label_ids;
+
+		names.reserve(topology_.NumOfStates());
+		ids.reserve(topology_.NumOfStates());
+		keys.reserve(topology_.NumOfStates());
+		offsets.reserve(topology_.NumOfStates() + 1);
+		frozen_edges.reserve(topology_.NumOfTransitions());
+
+		auto initial = topology_.states().find(topology_.initial_state());
+		names.emplace_back(&initial->first);
+		ids.emplace(&initial->first, 0);
+		offsets.emplace_back(0);
+
+		for (size_t id = 0; id < names.size(); ++id) {
+			const auto& state = topology_.states().at(*names[id]);
+			keys.emplace_back(codec_.Encode(*names[id]));
+			for (const auto& transition : state.transitions_) {
+				const auto& [resource, label] = transition.label();
+				auto [label_it, new_label] = label_ids.try_emplace(label.id(), static_cast<uint32_t>(labels.size()));
+				if (new_label) {
+					labels.emplace_back(label);
+				}
+				const std::vector<std::string>* to = &topology_.states().find(transition.to())->first;
+				auto [id_it, new_state] = ids.try_emplace(to, static_cast<uint32_t>(names.size()));
+				if (new_state) {
+					names.emplace_back(to);
+				}
+				frozen_edges.push_back({ static_cast<uint32_t>(resource), label_it->second, id_it->second });
+			}
+			offsets.emplace_back(frozen_edges.size());
+		}
+		return std::make_unique<FrozenTopology>(automata_, std::move(keys), std::move(offsets), std::move(frozen_edges), std::move(labels),
+			                                    checkpoint_interval);
+	}
+
+	void CompleteTopology::CombineRecursive(const PackedState& key) {
+		if (Visit(key) == false) {
 			return;
 		}
-		visited_.insert(states_vec);
+		std::vector<Edge> edges;
+		Expand(key, edges);
+		for (auto& edge : edges) {
+			AddEdge(key, edge);
+			CombineRecursive(edge.to);
+		}
+	}
 
-		for (size_t i = 0; i < ltss_.size(); ++i) {
-			for (const auto& transition : ltss_[i].states().at(states_vec[i]).transitions_) {
-				if ((transition.label().operation().find("in:") != std::string::npos) || (transition.label().operation().find("out:") != std::string::npos)) {
-					std::optional<std::vector<std::string>> transfer_state = MatchingTransfer(ltss_, states_vec, i, transition);
+	/*
+	 * @brief Computes the outgoing edges of a state in the same order as the DFS would add them.
+	 * Only reads from the resources and the codec, so it is safe to call from several threads.
+	 */
+	void CompleteTopology::Expand(const PackedState& key, std::vector<Edge>& edges) const {
+		edges.clear();
+		for (size_t i = 0; i < automata_->size(); ++i) {
+			const ResourceAutomaton& automaton = (*automata_)[i];
+			uint32_t local_state = codec_.Get(key, i);
+			std::span<const uint32_t> targets = automaton.targets(local_state);
+			std::span<const ParameterizedOp> labels = automaton.labels(local_state);
+			for (size_t t = 0; t < targets.size(); ++t) {
+				if (labels[t].IsTransfer()) {
+					std::optional<PackedState> transfer_state = MatchingTransfer(transfer_index_, codec_, key, i, labels[t], targets[t]);
 					if (!transfer_state.has_value()) {
 						continue;
 					}
-					topology_.AddTransition(states_vec, std::make_pair(i, transition.label()), *transfer_state);
-					CombineRecursive(*transfer_state);
-				}
-				else {
-					std::vector<std::string> next_states = states_vec;
-					next_states[i] = transition.to();
-					topology_.AddTransition(states_vec, std::make_pair(i, transition.label()), next_states);
-					CombineRecursive(next_states);
+					edges.push_back({ i, &labels[t], std::move(*transfer_state) });
+				} else {
+					PackedState next_key = key;
+					codec_.Set(next_key, i, targets[t]);
+					edges.push_back({ i, &labels[t], std::move(next_key) });
 				}
 			}
 		}
 	}
 
-	void CompleteTopology::CombineIterative(std::vector<std::string>& states_vec) {
-		std::stack<std::vector<std::string>> stack;
-		stack.push(states_vec);
+	void CompleteTopology::CombineIterative(const PackedState& initial_key) {
+		std::stack<PackedState> stack;
+		stack.push(initial_key);
+		std::vector<Edge> edges;
 
 		while (!stack.empty())
 		{
-			std::vector<std::string> states_vec = stack.top();
+			PackedState key = stack.top();
 			stack.pop();
 
-			if (visited_.contains(states_vec) == true) {
+			if (Visit(key) == false) {
 				continue;
 			}
-			visited_.insert(states_vec);
-
-			for (size_t i = 0; i < ltss_.size(); ++i) {
-				for (const auto& transition : ltss_[i].states().at(states_vec[i]).transitions_) {
-					if ((transition.label().operation().find("in:") != std::string::npos) || (transition.label().operation().find("out:") != std::string::npos)) {
-						std::optional<std::vector<std::string>> transfer_state = MatchingTransfer(ltss_, states_vec, i, transition);
-						if (!transfer_state.has_value()) {
-							continue;
-						}
-						topology_.AddTransition(states_vec, std::make_pair(i, transition.label()), *transfer_state);
-						stack.push(*transfer_state);
+			Expand(key, edges);
+			for (auto& edge : edges) {
+				AddEdge(key, edge);
+				stack.push(std::move(edge.to));
+			}
+		}
+	}
+
+	namespace {
+
+		/*
+		 * @brief Visited set split into independently locked shards, selected by the high bits of the state hash.
+		 */
+		class ShardedVisited {
+		private:
+			struct Shard {
+				std::mutex mutex;
+				PackedStateSet set;
+			};
+			std::vector<Shard> shards_;
+		public:
+			explicit ShardedVisited(size_t num_shards)
+				: shards_(num_shards) {}
+
+			bool Insert(const PackedState& key) {
+				size_t hash = key.Hash();
+				Shard& shard = shards_[(hash >> 16) % shards_.size()];
+				std::lock_guard<std::mutex> lock(shard.mutex);
+				return shard.set.Insert(key);
+			}
+
+			template <typename F>
+			void ForEach(F&& f) {
+				for (auto& shard : shards_) {
+					shard.set.ForEach(f);
+				}
+			}
+		};
+
+		/*
+		 * @brief Per-thread frontier: the owner works LIFO from the back, thieves take the oldest states from the front.
+		 */
+		class WorkQueue {
+		private:
+			std::mutex mutex_;
+			std::deque<PackedState> deque_;
+		public:
+			void Push(PackedState&& key) {
+				std::lock_guard<std::mutex> lock(mutex_);
+				deque_.emplace_back(std::move(key));
+			}
+
+			bool Pop(PackedState& key) {
+				std::lock_guard<std::mutex> lock(mutex_);
+				if (deque_.empty()) {
+					return false;
+				}
+				key = std::move(deque_.back());
+				deque_.pop_back();
+				return true;
+			}
+
+			bool Steal(PackedState& key) {
+				std::lock_guard<std::mutex> lock(mutex_);
+				if (deque_.empty()) {
+					return false;
+				}
+				key = std::move(deque_.front());
+				deque_.pop_front();
+				return true;
+			}
+		};
+
+		struct Expanded {
+			PackedState from;
+			std::vector<CompleteTopology::Edge> edges;
+		};
+
+	}
+
+	/*
+	 * @brief Parallel DFS: states are claimed in a sharded visited set when first discovered, expanded by whichever
+	 * worker gets to them first, and their edges are buffered per thread. The buffers are merged into the LTS once
+	 * every worker is idle, so the transitions of each state keep the serial order.
+	 */
+	void CompleteTopology::CombineParallel(const PackedState& initial_key, size_t num_threads) {
+		ShardedVisited visited(num_threads * 16);
+		std::vector<WorkQueue> queues(num_threads);
+		std::vector<std::vector<Expanded>> buffers(num_threads);
+		std::atomic<size_t> pending = 1;
+
+		visited.Insert(initial_key);
+		queues[0].Push(PackedState(initial_key));
+
+		auto worker = [&](size_t id) {
+			std::vector<Edge> edges;
+			PackedState key;
+			while (true) {
+				bool found = queues[id].Pop(key);
+				for (size_t k = 1; !found && k < num_threads; ++k) {
+					found = queues[(id + k) % num_threads].Steal(key);
+				}
+				if (!found) {
+					if (pending.load(std::memory_order_acquire) == 0) {
+						return;
 					}
-					else {
-						std::vector<std::string> next_states = states_vec;
-						next_states[i] = transition.to();
-						topology_.AddTransition(states_vec, std::make_pair(i, transition.label()), next_states);
-						stack.push(next_states);
+					std::this_thread::yield();
+					continue;
+				}
+
+				Expand(key, edges);
+				for (const auto& edge : edges) {
+					if (visited.Insert(edge.to)) {
+						pending.fetch_add(1, std::memory_order_relaxed);
+						queues[id].Push(PackedState(edge.to));
 					}
 				}
+				buffers[id].push_back({ std::move(key), edges });
+				pending.fetch_sub(1, std::memory_order_acq_rel);
+			}
+		};
+
+		std::vector<std::thread> threads;
+		threads.reserve(num_threads);
+		for (size_t i = 0; i < num_threads; ++i) {
+			threads.emplace_back(worker, i);
+		}
+		for (auto& t : threads) {
+			t.join();
+		}
+
+		for (auto& buffer : buffers) {
+			for (auto& expanded : buffer) {
+				for (const auto& edge : expanded.edges) {
+					AddEdge(expanded.from, edge);
+				}
 			}
+			buffer.clear();
 		}
+		visited.ForEach([this](const PackedState& key) { Visit(key); });
 	}
 }
\ No newline at end of file
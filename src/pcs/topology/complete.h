@@ -4,31 +4,62 @@
 #include <span>
 #include <optional>
 #include <string>
+#include <memory>
 #include <unordered_set>
+#include <unordered_map>
 
 #include <boost/container_hash/hash.hpp>
 
 #include "lts/lts.h"
 #include "pcs/topology/topology.h"
 #include "pcs/topology/core.h"
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/packed_state_set.h"
+#include "pcs/topology/direct_index.h"
+#include "pcs/topology/state_codec.h"
+#include "pcs/topology/resource_automaton.h"
+#include "pcs/topology/frozen.h"
+#include "pcs/topology/transfer_index.h"
 
 namespace pcs {
 
 	class CompleteTopology : public ITopology {
+	public:
+		/*
+		 * @brief An edge produced by expanding a packed state, label points into the resource it originates from.
+		 */
+		struct Edge {
+			size_t resource;
+			const ParameterizedOp* label;
+			PackedState to;
+		};
 	private:
 		nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>> topology_;
 
-		const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss_;
-		std::unordered_set<std::vector<std::string>, boost::hash<std::vector<std::string>>> visited_;
+		std::shared_ptr<const std::vector<ResourceAutomaton>> automata_;
+		StateCodec codec_;
+		TransferIndex transfer_index_;
+		PackedStateSet visited_;
+		// Replaces visited_ when the product of the resources is small enough, see DirectStateIndex
+		std::optional<DirectStateIndex> direct_;
+		// Key of every state of topology_, rendered once when the state is added, pointing at the key stored in topology_
+		std::unordered_map<PackedState, const std::vector<std::string>*, PackedStateHash> keys_;
 	public:
-		CompleteTopology(const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss, bool recursive=false);
+		CompleteTopology(const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss, bool recursive=false, size_t num_threads=1);
+		CompleteTopology(std::shared_ptr<const std::vector<ResourceAutomaton>> automata, bool recursive=false, size_t num_threads=1);
 		const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& lts() const override;
 		operator const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& () const;
 		const std::vector<std::string>& initial_state() const override;
 		const nightly::State<std::vector<std::string>, std::pair<size_t, ParameterizedOp>>& at(const std::vector<std::string>& key) override;
+
+		std::unique_ptr<FrozenTopology> Freeze(uint32_t checkpoint_interval = 1) const;
 	private:
-		void CombineRecursive(std::vector<std::string>& states_vec);
-		void CombineIterative(std::vector<std::string>& states_vec);
+		bool Visit(const PackedState& key);
+		void CombineRecursive(const PackedState& key);
+		void CombineIterative(const PackedState& initial_key);
+		void CombineParallel(const PackedState& initial_key, size_t num_threads);
+		void Expand(const PackedState& key, std::vector<Edge>& edges) const;
+		void AddEdge(const PackedState& from, const Edge& edge);
 	};
 
 }
\ No newline at end of file
@@ -23,15 +23,14 @@ namespace pcs {
 		                                                    const std::vector<std::string>& states_vec,
 		                                                    size_t current_ltss_idx, 
 		                                                    const nightly::Transition<std::string, ParameterizedOp>& current_transition) {
-		TransferOperation transfer = *(StringToTransfer(current_transition.label().operation()));
-		TransferOperation inverse = transfer.Inverse();
+		TransferOperation inverse = current_transition.label().transfer().Inverse();
 
 		for (size_t i = 0; i < ltss.size(); ++i) {
 			if (i == current_ltss_idx) {
 				continue;
 			}
 			for (const auto& t : ltss[i].states().at(states_vec[i]).transitions_) {
-				if (t.label().operation() == inverse.name()) {
+				if (t.label().IsTransfer() && t.label().transfer_type() == inverse.type() && t.label().transfer_n() == inverse.n()) {
 					std::vector<std::string> resulting_state = states_vec;
 					resulting_state[current_ltss_idx] = current_transition.to();
 					resulting_state[i] = t.to();
@@ -42,4 +41,43 @@ namespace pcs {
 		return {};
 	}
 
+	/*
+	 * @brief Finds the resource that synchronises with the given transfer from key using the inverted TransferIndex:
+	 * only resources offering the inverse transfer are probed, in ascending order, so the partner is the same one the
+	 * linear scan would find.
+	 * @param transfer: label of the current transition, must be a transfer
+	 */
+	std::optional<size_t> MatchingTransferPartner(const TransferIndex& index, const StateCodec& codec, const PackedState& key,
+		                                         size_t current_ltss_idx, const ParameterizedOp& transfer) {
+		TransferType inverse = (transfer.transfer_type() == TransferType::in) ? TransferType::out : TransferType::in;
+		size_t n = transfer.transfer_n();
+
+		for (size_t i : index.Resources(inverse, n)) {
+			if (i == current_ltss_idx) {
+				continue;
+			}
+			if (index.Target(i, codec.Get(key, i), inverse, n).has_value()) {
+				return i;
+			}
+		}
+		return {};
+	}
+
+	/*
+	 * @brief MatchingTransfer over packed states, see MatchingTransferPartner.
+	 * @param current_to: local end-state of the current transition in resource current_ltss_idx
+	 */
+	std::optional<PackedState> MatchingTransfer(const TransferIndex& index, const StateCodec& codec, const PackedState& key,
+		                                       size_t current_ltss_idx, const ParameterizedOp& transfer, uint32_t current_to) {
+		std::optional<size_t> partner = MatchingTransferPartner(index, codec, key, current_ltss_idx, transfer);
+		if (!partner.has_value()) {
+			return {};
+		}
+		TransferType inverse = (transfer.transfer_type() == TransferType::in) ? TransferType::out : TransferType::in;
+		PackedState resulting_state = key;
+		codec.Set(resulting_state, current_ltss_idx, current_to);
+		codec.Set(resulting_state, *partner, *index.Target(*partner, codec.Get(key, *partner), inverse, transfer.transfer_n()));
+		return resulting_state;
+	}
+
 }
\ No newline at end of file
@@ -10,10 +10,19 @@
 #include "lts/transition.h"
 #include "pcs/operation/transfer.h"
 #include "pcs/operation/parsers/label.h"
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/state_codec.h"
+#include "pcs/topology/transfer_index.h"
 
 namespace pcs {
 
 	std::optional<std::vector<std::string>> MatchingTransfer(const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss,
 		                                                    const std::vector<std::string>& states_vec, size_t current_ltss_idx, 
 		                                                    const nightly::Transition<std::string, ParameterizedOp>& current_transition);
+
+	std::optional<size_t> MatchingTransferPartner(const TransferIndex& index, const StateCodec& codec, const PackedState& key,
+		                                         size_t current_ltss_idx, const ParameterizedOp& transfer);
+
+	std::optional<PackedState> MatchingTransfer(const TransferIndex& index, const StateCodec& codec, const PackedState& key,
+		                                       size_t current_ltss_idx, const ParameterizedOp& transfer, uint32_t current_to);
 }
\ No newline at end of file
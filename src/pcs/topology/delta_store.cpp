@@ -0,0 +1,238 @@
+#include "pcs/topology/delta_store.h"
+
+#include <vector>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <algorithm>
+
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/state_codec.h"
+#include "pcs/topology/resource_automaton.h"
+
+namespace pcs {
+
+	namespace {
+
+		uint64_t SplitMix(uint64_t x) {
+			x += 0x9E3779B97F4A7C15ull;
+			x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+			x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+			return x ^ (x >> 31);
+		}
+
+	}
+
+	/*
+	 * @brief Whether a delta entry plus its share of a checkpoint every checkpoint_interval states takes fewer bytes than a
+	 * state of num_words words stored in full. With the default interval this needs states of at least five words.
+	 */
+	bool DeltaStateStore::Pays(size_t num_words, uint32_t checkpoint_interval) {
+		return checkpoint_interval > 1 && sizeof(Entry) * checkpoint_interval < num_words * sizeof(uint64_t) * (checkpoint_interval - 1);
+	}
+
+	/*
+	 * @param checkpoint_interval: @default = 16. Longest chain of deltas before a state is stored in full, 1 stores
+	 * every state in full. States are stored in full as well when deltas would not take less memory, see Pays
+	 */
+	DeltaStateStore::DeltaStateStore(std::shared_ptr<const std::vector<ResourceAutomaton>> automata, uint32_t checkpoint_interval)
+		: automata_(std::move(automata)), codec_(automata_), checkpoint_interval_(std::clamp<uint32_t>(checkpoint_interval, 1, UINT16_MAX)),
+		  is_delta_(Pays(codec_.NumOfWords(), checkpoint_interval_)) {
+		zobrist_offsets_.reserve(automata_->size());
+		for (size_t i = 0; i < automata_->size(); ++i) {
+			zobrist_offsets_.emplace_back(zobrist_.size());
+			for (uint32_t s = 0; s < (*automata_)[i].NumOfStates(); ++s) {
+				zobrist_.emplace_back(SplitMix((static_cast<uint64_t>(i) << 32) | s));
+			}
+		}
+		index_.assign(16, kNone);
+	}
+
+	bool DeltaStateStore::IsDelta() const {
+		return is_delta_;
+	}
+
+	size_t DeltaStateStore::size() const {
+		return size_;
+	}
+
+	/*
+	 * @brief The number of states stored in full, every state in the full layout
+	 */
+	size_t DeltaStateStore::NumOfCheckpoints() const {
+		return is_delta_ ? num_checkpoints_ : size_;
+	}
+
+	/*
+	 * @brief Bytes held by the entries, the checkpoints or full states and the index
+	 */
+	size_t DeltaStateStore::MemoryUsage() const {
+		return entries_.capacity() * sizeof(Entry) + checkpoints_.capacity() * sizeof(uint64_t) + words_.capacity() * sizeof(uint64_t) +
+			index_.capacity() * sizeof(uint32_t);
+	}
+
+	uint64_t DeltaStateStore::Hash(const PackedState& state) const {
+		uint64_t hash = 0;
+		for (size_t i = 0; i < automata_->size(); ++i) {
+			hash ^= Zobrist(i, codec_.Get(state, i));
+		}
+		return hash;
+	}
+
+	/*
+	 * @brief The Zobrist hash of state id, kept with the entry in the delta layout and computed in the full one
+	 */
+	uint64_t DeltaStateStore::Hash(uint32_t id) const {
+		return is_delta_ ? entries_[id].hash : Hash(Decode(id));
+	}
+
+	/*
+	 * @brief Interns state, in the delta layout as a delta from parent when it differs from it in at most two resources.
+	 * @param parent: @default = kNone. A state of the store, typically the one state was reached from
+	 * @returns The id of state and whether it was inserted, ids are dense and given in insertion order
+	 */
+	std::pair<uint32_t, bool> DeltaStateStore::Intern(const PackedState& state, uint32_t parent) {
+		const size_t num_words = codec_.NumOfWords();
+		if (!is_delta_) {
+			size_t slot;
+			std::optional<uint32_t> id = Find(state, Hash(state), &slot);
+			if (id.has_value()) {
+				return { *id, false };
+			}
+			for (size_t w = 0; w < num_words; ++w) {
+				words_.emplace_back(state.word(w));
+			}
+			index_[slot] = static_cast<uint32_t>(size_++);
+			if (size_ * 2 > index_.size()) {
+				Grow();
+			}
+			return { static_cast<uint32_t>(size_ - 1), true };
+		}
+
+		Entry entry{};
+		entry.parent = kNone;
+		if (parent != kNone) {
+			const Entry& from_entry = entries_[parent];
+			PackedState from = Decode(parent);
+			uint64_t hash = from_entry.hash;
+			size_t num_changes = 0;
+			for (size_t i = 0; i < automata_->size(); ++i) {
+				uint32_t before = codec_.Get(from, i);
+				uint32_t after = codec_.Get(state, i);
+				if (before == after) {
+					continue;
+				}
+				if (num_changes < 2) {
+					entry.resources[num_changes] = static_cast<uint32_t>(i);
+					entry.local_states[num_changes] = after;
+				}
+				++num_changes;
+				hash ^= Zobrist(i, before) ^ Zobrist(i, after);
+			}
+			entry.hash = hash;
+			if (num_changes <= 2 && from_entry.depth + 1u < checkpoint_interval_) {
+				entry.parent = parent;
+				entry.num_changes = static_cast<uint16_t>(num_changes);
+				entry.depth = static_cast<uint16_t>(from_entry.depth + 1);
+			}
+		} else {
+			entry.hash = Hash(state);
+		}
+
+		size_t slot;
+		std::optional<uint32_t> id = Find(state, entry.hash, &slot);
+		if (id.has_value()) {
+			return { *id, false };
+		}
+		if (entry.parent == kNone) {
+			entry.num_changes = 0;
+			entry.depth = 0;
+			entry.resources[0] = static_cast<uint32_t>(num_checkpoints_++);
+			for (size_t w = 0; w < num_words; ++w) {
+				checkpoints_.emplace_back(state.word(w));
+			}
+		}
+		entries_.emplace_back(entry);
+		index_[slot] = static_cast<uint32_t>(size_++);
+		if (size_ * 2 > index_.size()) {
+			Grow();
+		}
+		return { static_cast<uint32_t>(size_ - 1), true };
+	}
+
+	std::optional<uint32_t> DeltaStateStore::Find(const PackedState& state) const {
+		size_t slot;
+		return Find(state, Hash(state), &slot);
+	}
+
+	/*
+	 * @brief Linear probing from the slot picked by the hash. Full states are compared by their words, delta states by
+	 * their hash first and only decoded to confirm a match.
+	 * @param slot: set to the empty slot ending the probe if the state is not found
+	 */
+	std::optional<uint32_t> DeltaStateStore::Find(const PackedState& state, uint64_t hash, size_t* slot) const {
+		const size_t num_words = codec_.NumOfWords();
+		const size_t mask = index_.size() - 1;
+		for (size_t pos = hash & mask;; pos = (pos + 1) & mask) {
+			uint32_t id = index_[pos];
+			if (id == kNone) {
+				*slot = pos;
+				return {};
+			}
+			if (!is_delta_) {
+				bool equal = true;
+				for (size_t w = 0; w < num_words && equal; ++w) {
+					equal = (words_[id * num_words + w] == state.word(w));
+				}
+				if (equal) {
+					return id;
+				}
+			} else if (entries_[id].hash == hash && Decode(id) == state) {
+				return id;
+			}
+		}
+	}
+
+	/*
+	 * @brief Copies a full state, or applies the deltas from the nearest checkpoint up to id
+	 */
+	PackedState DeltaStateStore::Decode(uint32_t id) const {
+		const size_t num_words = codec_.NumOfWords();
+		PackedState state(num_words);
+		if (!is_delta_) {
+			for (size_t w = 0; w < num_words; ++w) {
+				state.set_word(w, words_[id * num_words + w]);
+			}
+			return state;
+		}
+		std::vector<uint32_t> chain;
+		chain.reserve(entries_[id].depth);
+		for (; entries_[id].parent != kNone; id = entries_[id].parent) {
+			chain.emplace_back(id);
+		}
+		for (size_t w = 0; w < num_words; ++w) {
+			state.set_word(w, checkpoints_[entries_[id].resources[0] * num_words + w]);
+		}
+		for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+			const Entry& entry = entries_[*it];
+			for (size_t c = 0; c < entry.num_changes; ++c) {
+				codec_.Set(state, entry.resources[c], entry.local_states[c]);
+			}
+		}
+		return state;
+	}
+
+	void DeltaStateStore::Grow() {
+		std::vector<uint32_t> index(index_.size() * 2, kNone);
+		const size_t mask = index.size() - 1;
+		for (uint32_t id = 0; id < size_; ++id) {
+			size_t pos = Hash(id) & mask;
+			while (index[pos] != kNone) {
+				pos = (pos + 1) & mask;
+			}
+			index[pos] = id;
+		}
+		index_ = std::move(index);
+	}
+
+}
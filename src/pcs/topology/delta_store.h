@@ -0,0 +1,81 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <cstdint>
+
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/state_codec.h"
+#include "pcs/topology/resource_automaton.h"
+
+namespace pcs {
+
+	/**
+	 * @brief Interned topology states, each stored either in full or as the one or two resources it changes from a parent state.
+	 *
+	 * A delta entry costs sizeof(Entry) bytes, so deltas are only used when that is less than the words of a full state,
+	 * see Pays; otherwise every state is stored in full as a row of words and the index compares rows directly. In the
+	 * delta layout a state that differs from its parent in more than two resources, or whose chain of parents reaches
+	 * checkpoint_interval, is stored in full instead, so decoding applies at most checkpoint_interval deltas to a
+	 * checkpoint. Every delta entry carries its Zobrist hash (the xor of a random word per resource and local state),
+	 * which is updated from the delta alone, so hashing and probing work on the encoded form. States are only decoded
+	 * to confirm a hash match.
+	 */
+	class DeltaStateStore {
+	public:
+		static constexpr uint32_t kNone = UINT32_MAX;
+	private:
+		struct Entry {
+			uint64_t hash;
+			// Parent state, or kNone for a checkpoint whose words start at resources[0] * num_words in checkpoints_
+			uint32_t parent;
+			uint16_t num_changes;
+			uint16_t depth;
+			uint32_t resources[2];
+			uint32_t local_states[2];
+		};
+
+		std::shared_ptr<const std::vector<ResourceAutomaton>> automata_;
+		StateCodec codec_;
+		uint32_t checkpoint_interval_;
+		// Zobrist words of local state s of resource i at zobrist_[zobrist_offsets_[i] + s]
+		std::vector<uint64_t> zobrist_;
+		std::vector<size_t> zobrist_offsets_;
+
+		bool is_delta_;
+		size_t size_ = 0;
+		// Delta layout: one entry per state, the words of the checkpoints in checkpoints_
+		std::vector<Entry> entries_;
+		std::vector<uint64_t> checkpoints_;
+		size_t num_checkpoints_ = 0;
+		// Full layout: the words of state id at words_[id * num_words]
+		std::vector<uint64_t> words_;
+		// Open addressing index from hash to state, kNone when empty
+		std::vector<uint32_t> index_;
+	public:
+		static bool Pays(size_t num_words, uint32_t checkpoint_interval);
+
+		DeltaStateStore(std::shared_ptr<const std::vector<ResourceAutomaton>> automata, uint32_t checkpoint_interval = 16);
+
+		bool IsDelta() const;
+		size_t size() const;
+		size_t NumOfCheckpoints() const;
+		size_t MemoryUsage() const;
+
+		std::pair<uint32_t, bool> Intern(const PackedState& state, uint32_t parent = kNone);
+		std::optional<uint32_t> Find(const PackedState& state) const;
+		PackedState Decode(uint32_t id) const;
+		uint64_t Hash(const PackedState& state) const;
+		uint64_t Hash(uint32_t id) const;
+	private:
+		uint64_t Zobrist(size_t resource, uint32_t local_state) const {
+			return zobrist_[zobrist_offsets_[resource] + local_state];
+		}
+
+		std::optional<uint32_t> Find(const PackedState& state, uint64_t hash, size_t* slot) const;
+		void Grow();
+	};
+
+}
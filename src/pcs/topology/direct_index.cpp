@@ -0,0 +1,89 @@
+#include "pcs/topology/direct_index.h"
+
+#include <vector>
+#include <bit>
+#include <limits>
+#include <stdexcept>
+#include <cstdint>
+
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/state_codec.h"
+
+namespace pcs {
+
+	/*
+	 * @brief The number of states of the product of the resources, saturated at the uint64_t maximum when the codec
+	 * does not use the MixedRadix layout
+	 */
+	uint64_t DirectStateIndex::NumOfCodes(const StateCodec& codec) {
+		if (codec.layout() != StateCodec::Layout::MixedRadix) {
+			return std::numeric_limits<uint64_t>::max();
+		}
+		uint64_t num_codes = 1;
+		for (size_t i = 0; i < codec.NumOfResources(); ++i) {
+			num_codes *= codec.radix(i);
+		}
+		return num_codes;
+	}
+
+	/*
+	 * @brief Whether the product of the resources has at most limit states, i.e. the bitmap takes at most limit / 8 bytes
+	 */
+	bool DirectStateIndex::Fits(const StateCodec& codec, uint64_t limit) {
+		return NumOfCodes(codec) <= limit;
+	}
+
+	/*
+	 * @param limit: @default = kDirectAddressLimit. Largest product the bitmap may cover
+	 * @exception Throws std::invalid_argument if the product of the resources exceeds limit, see Fits
+	 */
+	DirectStateIndex::DirectStateIndex(const StateCodec& codec, uint64_t limit) : num_codes_(NumOfCodes(codec)) {
+		if (num_codes_ > limit) {
+			throw std::invalid_argument("The product of the resources is too large to be addressed directly");
+		}
+		bits_.assign((num_codes_ + 63) / 64, 0);
+	}
+
+	size_t DirectStateIndex::size() const {
+		return size_;
+	}
+
+	uint64_t DirectStateIndex::NumOfCodes() const {
+		return num_codes_;
+	}
+
+	/*
+	 * @brief Bytes held by the bitmap and the rank directory
+	 */
+	size_t DirectStateIndex::MemoryUsage() const {
+		return bits_.capacity() * sizeof(uint64_t) + block_ranks_.capacity() * sizeof(uint32_t);
+	}
+
+	/*
+	 * @brief Builds the rank directory, must be called again after inserting to keep Rank valid
+	 */
+	void DirectStateIndex::IndexRanks() {
+		block_ranks_.assign((bits_.size() + kBlockWords - 1) / kBlockWords, 0);
+		uint32_t rank = 0;
+		for (size_t w = 0; w < bits_.size(); ++w) {
+			if (w % kBlockWords == 0) {
+				block_ranks_[w / kBlockWords] = rank;
+			}
+			rank += static_cast<uint32_t>(std::popcount(bits_[w]));
+		}
+	}
+
+	/*
+	 * @brief The number of visited codes below the code of state, dense in [0, size()) over the visited states
+	 */
+	uint32_t DirectStateIndex::Rank(const PackedState& state) const {
+		const uint64_t code = state.word(0);
+		const size_t word = static_cast<size_t>(code >> 6);
+		uint32_t rank = block_ranks_[word / kBlockWords];
+		for (size_t w = word - word % kBlockWords; w < word; ++w) {
+			rank += static_cast<uint32_t>(std::popcount(bits_[w]));
+		}
+		return rank + static_cast<uint32_t>(std::popcount(bits_[word] & ((uint64_t(1) << (code & 63)) - 1)));
+	}
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/state_codec.h"
+
+namespace pcs {
+
+	/**
+	 * @brief Insert-only set of PackedStates addressed directly by their mixed-radix code, for products small enough
+	 * to give every state of the product a bit.
+	 *
+	 * A state is visited when the bit of its code (the single word of the MixedRadix layout of StateCodec) is set, so
+	 * lookups do no hashing or probing. Once exploration is done, IndexRanks counts the set bits per block of words and
+	 * Rank then maps a visited state to its dense position among the visited codes, which indexes per-state arrays.
+	 */
+	class DirectStateIndex {
+	public:
+		static constexpr uint64_t kDirectAddressLimit = uint64_t(1) << 28;
+		static constexpr size_t kBlockWords = 8;
+	private:
+		uint64_t num_codes_;
+		size_t size_ = 0;
+		std::vector<uint64_t> bits_;
+		// Number of set bits before each block of kBlockWords words, filled by IndexRanks
+		std::vector<uint32_t> block_ranks_;
+	public:
+		static uint64_t NumOfCodes(const StateCodec& codec);
+		static bool Fits(const StateCodec& codec, uint64_t limit = kDirectAddressLimit);
+
+		DirectStateIndex(const StateCodec& codec, uint64_t limit = kDirectAddressLimit);
+
+		size_t size() const;
+		uint64_t NumOfCodes() const;
+		size_t MemoryUsage() const;
+
+		void IndexRanks();
+		uint32_t Rank(const PackedState& state) const;
+
+		bool Insert(const PackedState& state) {
+			const uint64_t code = state.word(0);
+			const uint64_t mask = uint64_t(1) << (code & 63);
+			uint64_t& word = bits_[code >> 6];
+			if ((word & mask) != 0) {
+				return false;
+			}
+			word |= mask;
+			++size_;
+			return true;
+		}
+
+		bool Contains(const PackedState& state) const {
+			const uint64_t code = state.word(0);
+			return (bits_[code >> 6] >> (code & 63)) & 1;
+		}
+
+		/*
+		 * @brief Calls f with every state of the set, in ascending code (and so rank) order
+		 */
+		template <typename F>
+		void ForEach(F&& f) const {
+			PackedState state(1);
+			for (size_t w = 0; w < bits_.size(); ++w) {
+				for (uint64_t word = bits_[w]; word != 0; word &= word - 1) {
+					state.set_word(0, (static_cast<uint64_t>(w) << 6) | static_cast<uint64_t>(std::countr_zero(word)));
+					f(state);
+				}
+			}
+		}
+	};
+
+}
@@ -0,0 +1,545 @@
+#include "pcs/topology/distributed.h"
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <optional>
+#include <iterator>
+#include <filesystem>
+#include <system_error>
+#include <cstdint>
+#include <cerrno>
+
+#if !defined(_WIN32)
+#define PCS_DISTRIBUTED_PROCESSES
+#include <unistd.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#endif
+
+#include "pcs/topology/frozen.h"
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/delta_store.h"
+#include "pcs/topology/successors.h"
+#include "pcs/topology/resource_automaton.h"
+
+namespace pcs {
+
+	namespace {
+
+		size_t Owner(const PackedState& state, size_t num_workers) {
+			return (state.Hash() >> 32) % num_workers;
+		}
+
+		PackedState ReadState(const uint64_t* words, size_t num_words) {
+			PackedState state(num_words);
+			for (size_t w = 0; w < num_words; ++w) {
+				state.set_word(w, words[w]);
+			}
+			return state;
+		}
+
+		void WriteState(std::vector<uint64_t>& words, const PackedState& state) {
+			for (size_t w = 0; w < state.NumOfWords(); ++w) {
+				words.emplace_back(state.word(w));
+			}
+		}
+
+		enum Command : uint64_t { kRound = 0, kSize = 1, kQuery = 2, kLookup = 3, kResolve = 4, kFinish = 5 };
+
+		/*
+		 * @brief The partition of the states owned by one worker, numbered by local ids in the order the worker visits them.
+		 *
+		 * An edge does not keep the key of its target: the target is interned in a query table of its owner, so every
+		 * target the worker needs is held once whatever the number of edges into it. The new entries of the query
+		 * tables are the frontier of the next round. Once exploration is done, the owners look the queries up and
+		 * answer with global ids (see Resolve), after which Finish writes the partition as a CSR shard.
+		 */
+		class PartitionWorker {
+		private:
+			struct Edge {
+				uint32_t resource;
+				uint32_t label;
+				// Index in the query table of the owner of the target, times the number of workers, plus the owner
+				uint64_t target;
+			};
+
+			std::shared_ptr<const std::vector<ResourceAutomaton>> automata_;
+			const SuccessorGenerator* generator_;
+			size_t num_words_;
+			size_t num_workers_;
+			DeltaStateStore states_;
+			std::vector<uint64_t> offsets_;
+			std::vector<Edge> edges_;
+			std::vector<std::unique_ptr<DeltaStateStore>> queries_;
+			// Global id of every query, per owner, filled by Resolve
+			std::vector<std::vector<uint32_t>> resolved_;
+		public:
+			PartitionWorker(std::shared_ptr<const std::vector<ResourceAutomaton>> automata, const SuccessorGenerator* generator, size_t num_workers)
+				: automata_(automata), generator_(generator), num_words_(generator->codec().NumOfWords()), num_workers_(num_workers),
+				  states_(automata, 1), offsets_(1, 0), resolved_(num_workers) {
+				for (size_t o = 0; o < num_workers_; ++o) {
+					queries_.emplace_back(std::make_unique<DeltaStateStore>(automata_, 1));
+				}
+			}
+
+			std::vector<uint64_t> Handle(uint64_t command, const std::vector<uint64_t>& words) {
+				switch (command) {
+				case kRound:
+					return Round(words);
+				case kSize:
+					return { states_.size() };
+				case kQuery:
+					return Query(words[0]);
+				case kLookup:
+					return Lookup(words);
+				case kResolve:
+					return Resolve(words);
+				case kFinish:
+					return Finish();
+				default:
+					throw std::invalid_argument("Unknown topology worker command");
+				}
+			}
+		private:
+			/*
+			 * @brief Expands the states of incoming that were not visited yet
+			 * @returns The key words of the successors that were not asked for before
+			 */
+			std::vector<uint64_t> Round(const std::vector<uint64_t>& incoming) {
+				std::vector<uint64_t> outgoing;
+				for (size_t offset = 0; offset < incoming.size(); offset += num_words_) {
+					PackedState state = ReadState(incoming.data() + offset, num_words_);
+					if (!states_.Intern(state).second) {
+						continue;
+					}
+					for (const Successor& successor : generator_->Successors(state)) {
+						const ResourceAutomaton& automaton = generator_->automata()[successor.resource];
+						const size_t owner = Owner(successor.state, num_workers_);
+						auto [query, is_new] = queries_[owner]->Intern(successor.state);
+						edges_.push_back({ static_cast<uint32_t>(successor.resource), static_cast<uint32_t>(successor.label - automaton.labels(0).data()),
+							               static_cast<uint64_t>(query) * num_workers_ + owner });
+						if (is_new) {
+							WriteState(outgoing, successor.state);
+						}
+					}
+					offsets_.emplace_back(edges_.size());
+				}
+				return outgoing;
+			}
+
+			/*
+			 * @returns The key words of the targets owned by worker owner, in query order
+			 */
+			std::vector<uint64_t> Query(size_t owner) const {
+				std::vector<uint64_t> keys;
+				keys.reserve(queries_[owner]->size() * num_words_);
+				for (uint32_t query = 0; query < queries_[owner]->size(); ++query) {
+					WriteState(keys, queries_[owner]->Decode(query));
+				}
+				return keys;
+			}
+
+			/*
+			 * @returns The local id of every state of keys
+			 * @exception Throws std::runtime_error if a state was never visited by this worker
+			 */
+			std::vector<uint64_t> Lookup(const std::vector<uint64_t>& keys) const {
+				std::vector<uint64_t> ids;
+				ids.reserve(keys.size() / num_words_);
+				for (size_t offset = 0; offset < keys.size(); offset += num_words_) {
+					std::optional<uint32_t> id = states_.Find(ReadState(keys.data() + offset, num_words_));
+					if (!id.has_value()) {
+						throw std::runtime_error("A topology worker was asked for a state it does not own");
+					}
+					ids.emplace_back(*id);
+				}
+				return ids;
+			}
+
+			/*
+			 * @param words: the owner, the global id of its first state and the local ids of the queries to it
+			 */
+			std::vector<uint64_t> Resolve(const std::vector<uint64_t>& words) {
+				const size_t owner = words[0];
+				resolved_[owner].reserve(words.size() - 2);
+				for (size_t q = 2; q < words.size(); ++q) {
+					resolved_[owner].emplace_back(static_cast<uint32_t>(words[1] + words[q]));
+				}
+				queries_[owner].reset();
+				return {};
+			}
+
+			/*
+			 * @returns Per state in local id order its key words, its number of edges and per edge the resource, the
+			 * index of the label in the labels of the resource and the global id of the target
+			 */
+			std::vector<uint64_t> Finish() const {
+				std::vector<uint64_t> shard;
+				shard.reserve(states_.size() * (num_words_ + 1) + edges_.size() * 3);
+				for (uint32_t id = 0; id < states_.size(); ++id) {
+					WriteState(shard, states_.Decode(id));
+					shard.emplace_back(offsets_[id + 1] - offsets_[id]);
+					for (uint64_t e = offsets_[id]; e < offsets_[id + 1]; ++e) {
+						shard.emplace_back(edges_[e].resource);
+						shard.emplace_back(edges_[e].label);
+						shard.emplace_back(resolved_[edges_[e].target % num_workers_][edges_[e].target / num_workers_]);
+					}
+				}
+				return shard;
+			}
+		};
+
+		/*
+		 * @brief Runs the partitions in the calling process, a request is handled as soon as it is sent
+		 */
+		class LocalWorkers {
+		private:
+			std::vector<PartitionWorker> workers_;
+			std::vector<std::vector<uint64_t>> replies_;
+		public:
+			LocalWorkers(std::shared_ptr<const std::vector<ResourceAutomaton>> automata, const SuccessorGenerator* generator, size_t num_workers)
+				: replies_(num_workers) {
+				workers_.reserve(num_workers);
+				for (size_t i = 0; i < num_workers; ++i) {
+					workers_.emplace_back(automata, generator, num_workers);
+				}
+			}
+
+			void Send(size_t worker, uint64_t command, const std::vector<uint64_t>& words) {
+				replies_[worker] = workers_[worker].Handle(command, words);
+			}
+
+			std::vector<uint64_t> Receive(size_t worker) {
+				return std::move(replies_[worker]);
+			}
+		};
+
+#if defined(PCS_DISTRIBUTED_PROCESSES)
+		void WriteAll(int fd, const void* data, size_t num_bytes) {
+			const char* bytes = static_cast<const char*>(data);
+			while (num_bytes > 0) {
+				ssize_t written = ::send(fd, bytes, num_bytes, MSG_NOSIGNAL);
+				if (written < 0 && errno == EINTR) {
+					continue;
+				}
+				if (written <= 0) {
+					throw std::runtime_error("Failed to write to a topology worker");
+				}
+				bytes += written;
+				num_bytes -= static_cast<size_t>(written);
+			}
+		}
+
+		void ReadAll(int fd, void* data, size_t num_bytes) {
+			char* bytes = static_cast<char*>(data);
+			while (num_bytes > 0) {
+				ssize_t received = ::recv(fd, bytes, num_bytes, 0);
+				if (received < 0 && errno == EINTR) {
+					continue;
+				}
+				if (received <= 0) {
+					throw std::runtime_error("A topology worker exited unexpectedly");
+				}
+				bytes += received;
+				num_bytes -= static_cast<size_t>(received);
+			}
+		}
+
+		/*
+		 * @brief Messages are a command and a word count followed by that many words
+		 */
+		void WriteMessage(int fd, uint64_t command, const std::vector<uint64_t>& words) {
+			uint64_t header[2] = { command, words.size() };
+			WriteAll(fd, header, sizeof(header));
+			WriteAll(fd, words.data(), words.size() * sizeof(uint64_t));
+		}
+
+		uint64_t ReadMessage(int fd, std::vector<uint64_t>& words) {
+			uint64_t header[2];
+			ReadAll(fd, header, sizeof(header));
+			words.resize(header[1]);
+			ReadAll(fd, words.data(), words.size() * sizeof(uint64_t));
+			return header[0];
+		}
+
+		/*
+		 * @brief The number of threads of this process, 0 if it cannot be told
+		 */
+		size_t NumOfThreads() {
+			std::error_code error;
+			std::filesystem::directory_iterator tasks("/proc/self/task", error);
+			if (error) {
+				return 0;
+			}
+			return static_cast<size_t>(std::distance(tasks, std::filesystem::directory_iterator()));
+		}
+
+		/*
+		 * @brief Runs every partition in a child process forked from the coordinator, which inherits the compiled
+		 * resources, so only states, ids and edges cross the sockets.
+		 *
+		 * Only the forking thread exists in a child, so a lock another thread held at the fork (the allocator's, the
+		 * LabelTable's) would never be released there. Workers are therefore only forked from a single-threaded process;
+		 * a child never interns labels and only runs PartitionWorker until it exits.
+		 */
+		class ProcessWorkers {
+		private:
+			std::vector<pid_t> pids_;
+			std::vector<int> fds_;
+		public:
+			/*
+			 * @exception Throws std::logic_error if the process runs more than one thread
+			 */
+			ProcessWorkers(std::shared_ptr<const std::vector<ResourceAutomaton>> automata, const SuccessorGenerator* generator, size_t num_workers) {
+				if (NumOfThreads() > 1) {
+					throw std::logic_error("Topology worker processes can only be forked from a single-threaded process");
+				}
+				try {
+					for (size_t i = 0; i < num_workers; ++i) {
+						int fds[2];
+						if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+							throw std::runtime_error("Failed to create a socket pair for a topology worker");
+						}
+						pid_t pid = ::fork();
+						if (pid < 0) {
+							::close(fds[0]);
+							::close(fds[1]);
+							throw std::runtime_error("Failed to fork a topology worker");
+						}
+						if (pid == 0) {
+							::close(fds[0]);
+							for (int fd : fds_) {
+								::close(fd);
+							}
+							Serve(fds[1], automata, generator, num_workers);
+						}
+						::close(fds[1]);
+						pids_.emplace_back(pid);
+						fds_.emplace_back(fds[0]);
+					}
+				} catch (...) {
+					Stop();
+					throw;
+				}
+			}
+
+			ProcessWorkers(const ProcessWorkers&) = delete;
+			ProcessWorkers& operator=(const ProcessWorkers&) = delete;
+
+			~ProcessWorkers() {
+				Stop();
+			}
+
+			/*
+			 * @brief A worker only replies once it read the whole request, so requests can be sent to every worker
+			 * before any reply is read without either side blocking the other.
+			 */
+			void Send(size_t worker, uint64_t command, const std::vector<uint64_t>& words) {
+				WriteMessage(fds_[worker], command, words);
+			}
+
+			std::vector<uint64_t> Receive(size_t worker) {
+				std::vector<uint64_t> words;
+				ReadMessage(fds_[worker], words);
+				return words;
+			}
+		private:
+			[[noreturn]] static void Serve(int fd, std::shared_ptr<const std::vector<ResourceAutomaton>> automata, const SuccessorGenerator* generator,
+				                           size_t num_workers) {
+				int status = 0;
+				try {
+					PartitionWorker worker(std::move(automata), generator, num_workers);
+					std::vector<uint64_t> request;
+					for (uint64_t command = kRound; command != kFinish;) {
+						command = ReadMessage(fd, request);
+						WriteMessage(fd, command, worker.Handle(command, request));
+					}
+				} catch (...) {
+					status = 1;
+				}
+				::close(fd);
+				::_exit(status);
+			}
+
+			/*
+			 * @brief Closing the socket ends a worker that is waiting for a message, the ones still running are killed
+			 */
+			void Stop() {
+				for (int fd : fds_) {
+					::close(fd);
+				}
+				for (pid_t pid : pids_) {
+					int status;
+					if (::waitpid(pid, &status, WNOHANG) == 0) {
+						::kill(pid, SIGTERM);
+						::waitpid(pid, &status, 0);
+					}
+				}
+				fds_.clear();
+				pids_.clear();
+			}
+		};
+#endif
+
+		/*
+		 * @brief Level-synchronous exploration: every round routes the new successors of the last round to the workers
+		 * owning them. Workers only reply once they expanded their whole inbox, so when every outbox comes back empty no
+		 * state is in flight anywhere and the construction has terminated.
+		 */
+		template <typename Workers>
+		void Explore(Workers& workers, const PackedState& initial_state, size_t num_workers) {
+			const size_t num_words = initial_state.NumOfWords();
+			std::vector<std::vector<uint64_t>> inboxes(num_workers);
+			WriteState(inboxes[Owner(initial_state, num_workers)], initial_state);
+			while (std::any_of(inboxes.begin(), inboxes.end(), [](const auto& inbox) { return !inbox.empty(); })) {
+				for (size_t i = 0; i < num_workers; ++i) {
+					workers.Send(i, kRound, inboxes[i]);
+					inboxes[i].clear();
+				}
+				for (size_t i = 0; i < num_workers; ++i) {
+					std::vector<uint64_t> outbox = workers.Receive(i);
+					for (size_t offset = 0; offset < outbox.size(); offset += num_words) {
+						PackedState state = ReadState(outbox.data() + offset, num_words);
+						WriteState(inboxes[Owner(state, num_workers)], state);
+					}
+				}
+			}
+		}
+
+		/*
+		 * @brief Numbers the partitions one after the other from the one owning the initial state, so it gets id 0, and
+		 * has every worker resolve its edge targets to global ids, one owner at a time.
+		 */
+		template <typename Workers>
+		void Resolve(Workers& workers, const std::vector<size_t>& order, size_t num_words) {
+			const size_t num_workers = order.size();
+			std::vector<uint64_t> first_ids(num_workers, 0);
+			for (size_t i = 0; i < num_workers; ++i) {
+				workers.Send(i, kSize, {});
+			}
+			std::vector<uint64_t> sizes(num_workers);
+			for (size_t i = 0; i < num_workers; ++i) {
+				sizes[i] = workers.Receive(i)[0];
+			}
+			uint64_t num_states = 0;
+			for (size_t owner : order) {
+				first_ids[owner] = num_states;
+				num_states += sizes[owner];
+			}
+			if (num_states > UINT32_MAX) {
+				throw std::length_error("Too many states for a frozen topology");
+			}
+
+			for (size_t owner = 0; owner < num_workers; ++owner) {
+				std::vector<uint64_t> keys;
+				std::vector<size_t> num_queries(num_workers);
+				for (size_t i = 0; i < num_workers; ++i) {
+					workers.Send(i, kQuery, { owner });
+				}
+				for (size_t i = 0; i < num_workers; ++i) {
+					std::vector<uint64_t> queries = workers.Receive(i);
+					num_queries[i] = queries.size() / num_words;
+					keys.insert(keys.end(), queries.begin(), queries.end());
+				}
+				workers.Send(owner, kLookup, keys);
+				keys.clear();
+				std::vector<uint64_t> ids = workers.Receive(owner);
+				size_t offset = 0;
+				for (size_t i = 0; i < num_workers; ++i) {
+					std::vector<uint64_t> resolution{ owner, first_ids[owner] };
+					resolution.insert(resolution.end(), ids.begin() + offset, ids.begin() + offset + num_queries[i]);
+					offset += num_queries[i];
+					workers.Send(i, kResolve, resolution);
+				}
+				for (size_t i = 0; i < num_workers; ++i) {
+					workers.Receive(i);
+				}
+			}
+		}
+
+		/*
+		 * @brief Appends the shards of the workers in id order to one FrozenTopology, reading one shard at a time
+		 */
+		template <typename Workers>
+		std::unique_ptr<FrozenTopology> Merge(Workers& workers, const std::vector<size_t>& order, std::shared_ptr<const std::vector<ResourceAutomaton>> automata,
+			                                  size_t num_words) {
+			std::vector<PackedState> keys;
+			std::vector<uint64_t> offsets(1, 0);
+			std::vector<FrozenTopology::Edge> edges;
+			std::vector<ParameterizedOp> labels;
+			std::unordered_map<uint32_t, uint32_t> label_ids;
+			for (size_t owner : order) {
+				workers.Send(owner, kFinish, {});
+				const std::vector<uint64_t> shard = workers.Receive(owner);
+				for (size_t offset = 0; offset < shard.size();) {
+					keys.emplace_back(ReadState(shard.data() + offset, num_words));
+					const uint64_t num_edges = shard[offset + num_words];
+					offset += num_words + 1;
+					for (uint64_t e = 0; e < num_edges; ++e, offset += 3) {
+						const ParameterizedOp& label = (*automata)[shard[offset]].labels(0).data()[shard[offset + 1]];
+						auto [label_it, new_label] = label_ids.try_emplace(label.id(), static_cast<uint32_t>(labels.size()));
+						if (new_label) {
+							labels.emplace_back(label);
+						}
+						edges.push_back({ static_cast<uint32_t>(shard[offset]), label_it->second, static_cast<uint32_t>(shard[offset + 2]) });
+					}
+					offsets.emplace_back(edges.size());
+				}
+			}
+			return std::make_unique<FrozenTopology>(automata, std::move(keys), std::move(offsets), std::move(edges), std::move(labels));
+		}
+
+		template <typename Workers>
+		std::unique_ptr<FrozenTopology> Build(Workers& workers, std::shared_ptr<const std::vector<ResourceAutomaton>> automata,
+			                                  const PackedState& initial_state, size_t num_workers) {
+			Explore(workers, initial_state, num_workers);
+			std::vector<size_t> order;
+			for (size_t k = 0; k < num_workers; ++k) {
+				order.emplace_back((Owner(initial_state, num_workers) + k) % num_workers);
+			}
+			Resolve(workers, order, initial_state.NumOfWords());
+			return Merge(workers, order, std::move(automata), initial_state.NumOfWords());
+		}
+
+	}
+
+	/*
+	 * @brief Builds the frozen topology with the states partitioned over num_workers workers by the hash of their key.
+	 *
+	 * Each worker keeps the visited set and the edges of the states it owns and numbers its states itself. A coordinator
+	 * routes the frontier between them round by round (see Explore), then has the workers resolve the targets of their
+	 * edges to global ids with the owners of the targets (see Resolve) and appends their CSR shards to one FrozenTopology
+	 * (see Merge). Besides the topology it builds, the coordinator holds at most one round of frontier, the queries to
+	 * one partition or one shard. States are numbered partition by partition, so ids differ from CompleteTopology::Freeze
+	 * while the topology is the same; the initial state has id 0.
+	 *
+	 * Worker processes are forked, which is only safe while the calling process runs a single thread.
+	 * @param mode: @default = WorkerMode::process. Platforms without fork always run in_process
+	 * @exception Throws std::invalid_argument if num_workers is 0, std::logic_error if mode is process and the process
+	 * runs other threads, std::runtime_error if a worker cannot be started or fails
+	 */
+	std::unique_ptr<FrozenTopology> BuildDistributedTopology(std::shared_ptr<const std::vector<ResourceAutomaton>> automata, size_t num_workers,
+		                                                     WorkerMode mode) {
+		if (num_workers == 0) {
+			throw std::invalid_argument("A distributed topology needs at least one worker");
+		}
+		SuccessorGenerator generator(automata);
+		const PackedState initial_state = generator.initial_state();
+
+#if defined(PCS_DISTRIBUTED_PROCESSES)
+		if (mode == WorkerMode::process) {
+			ProcessWorkers workers(automata, &generator, num_workers);
+			return Build(workers, automata, initial_state, num_workers);
+		}
+#endif
+		LocalWorkers workers(automata, &generator, num_workers);
+		return Build(workers, automata, initial_state, num_workers);
+	}
+
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include "pcs/topology/frozen.h"
+#include "pcs/topology/resource_automaton.h"
+
+namespace pcs {
+
+	/*
+	 * @brief How the partitions of BuildDistributedTopology run: each in a forked worker process talking to the
+	 * coordinator over a socket pair, or all in the coordinator's process. Workers are only forked from a single-threaded
+	 * process, see BuildDistributedTopology
+	 */
+	enum class WorkerMode { process, in_process };
+
+	std::unique_ptr<FrozenTopology> BuildDistributedTopology(std::shared_ptr<const std::vector<ResourceAutomaton>> automata, size_t num_workers,
+		                                                     WorkerMode mode = WorkerMode::process);
+
+}
@@ -0,0 +1,78 @@
+#include "pcs/topology/estimator.h"
+
+#include <vector>
+#include <string>
+#include <array>
+#include <memory>
+#include <random>
+#include <algorithm>
+#include <unordered_set>
+
+#include "pcs/operation/parameterized_op.h"
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/successors.h"
+#include "pcs/topology/resource_automaton.h"
+
+namespace pcs {
+
+	/*
+	 * @brief Estimates the reachable states and the branching factor of the product of the resources by random walks.
+	 *
+	 * Every walk starts in the initial state and follows uniformly chosen successors for up to walk_length steps.
+	 * Even and odd walks form two independent samples of states and the number of states is the capture-recapture
+	 * estimate |A| |B| / |A n B|, clamped between the distinct states seen and the product of the resource sizes. Walks
+	 * share their start, so the estimate leans low on topologies much larger than the samples.
+	 * @param seed: @default = 0. Seed of the walks, the estimate is deterministic for a given seed
+	 */
+	TopologyEstimate EstimateTopology(std::shared_ptr<const std::vector<ResourceAutomaton>> automata, size_t num_walks, size_t walk_length,
+		                              uint64_t seed) {
+		SuccessorGenerator generator(automata);
+		std::mt19937_64 rng(seed);
+		std::array<std::unordered_set<PackedState, PackedStateHash>, 2> samples;
+		std::vector<PackedState> successors;
+		size_t num_expanded = 0;
+		size_t num_transitions = 0;
+
+		for (size_t walk = 0; walk < num_walks; ++walk) {
+			auto& sample = samples[walk % 2];
+			PackedState state = generator.initial_state();
+			sample.insert(state);
+			for (size_t step = 0; step < walk_length; ++step) {
+				successors.clear();
+				for (const Successor& successor : generator.Successors(state)) {
+					successors.emplace_back(successor.state);
+				}
+				++num_expanded;
+				num_transitions += successors.size();
+				if (successors.empty()) {
+					break;
+				}
+				state = successors[std::uniform_int_distribution<size_t>(0, successors.size() - 1)(rng)];
+				sample.insert(state);
+			}
+		}
+
+		double bound = 1;
+		for (const auto& automaton : *automata) {
+			bound *= static_cast<double>(automaton.NumOfStates());
+		}
+		size_t overlap = 0;
+		for (const auto& state : samples[0]) {
+			overlap += samples[1].contains(state);
+		}
+
+		TopologyEstimate estimate;
+		estimate.num_sampled_states = samples[0].size() + samples[1].size() - overlap;
+		estimate.num_states = (overlap > 0) ? static_cast<double>(samples[0].size()) * static_cast<double>(samples[1].size()) / overlap : bound;
+		estimate.num_states = std::clamp(estimate.num_states, static_cast<double>(estimate.num_sampled_states), bound);
+		estimate.branching_factor = (num_expanded > 0) ? static_cast<double>(num_transitions) / num_expanded : 0;
+
+		// A state holds its key in the LTS map, every transition holds a copy of its target key and its label
+		const double key_size = static_cast<double>(sizeof(std::vector<std::string>) + automata->size() * sizeof(std::string));
+		const double state_size = key_size + 64;
+		const double transition_size = key_size + sizeof(std::pair<size_t, ParameterizedOp>);
+		estimate.num_bytes = estimate.num_states * (state_size + estimate.branching_factor * transition_size);
+		return estimate;
+	}
+
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "pcs/topology/resource_automaton.h"
+
+namespace pcs {
+
+	inline constexpr size_t kTopologyMemoryBudget = size_t(1) << 30;
+
+	/**
+	 * @brief Sampled estimate of the size of the complete topology, see EstimateTopology.
+	 */
+	struct TopologyEstimate {
+		// Estimated number of reachable states, between the distinct states sampled and the product of the resource sizes
+		double num_states = 0;
+		// Mean number of outgoing transitions of the sampled states
+		double branching_factor = 0;
+		// Distinct states seen by the walks, a lower bound on the number of reachable states
+		size_t num_sampled_states = 0;
+		// Rough memory needed to store the complete topology, in bytes
+		double num_bytes = 0;
+	};
+
+	TopologyEstimate EstimateTopology(std::shared_ptr<const std::vector<ResourceAutomaton>> automata, size_t num_walks = 64,
+		                              size_t walk_length = 256, uint64_t seed = 0);
+
+}
@@ -0,0 +1,405 @@
+#include "pcs/topology/external.h"
+
+#include <vector>
+#include <span>
+#include <string>
+#include <fstream>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+#include "pcs/topology/frozen.h"
+#include "pcs/topology/snapshot.h"
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/resource_automaton.h"
+#include "pcs/topology/successors.h"
+#include "pcs/common/directory.h"
+
+namespace pcs {
+
+	namespace {
+
+		/*
+		 * @brief Lexicographic compare of the key words [offset, offset + width) of two records
+		 */
+		bool Less(const uint64_t* lhs, const uint64_t* rhs, size_t offset, size_t width) {
+			return std::lexicographical_compare(lhs + offset, lhs + offset + width, rhs + offset, rhs + offset + width);
+		}
+
+		bool Equal(const uint64_t* lhs, const uint64_t* rhs, size_t offset, size_t width) {
+			return std::equal(lhs + offset, lhs + offset + width, rhs + offset);
+		}
+
+		/*
+		 * @brief Sequential writer of fixed-width records of uint64 words
+		 */
+		class RecordWriter {
+		private:
+			std::ofstream os_;
+			size_t width_;
+			uint64_t count_ = 0;
+		public:
+			RecordWriter(const std::filesystem::path& path, size_t width)
+				: width_(width) {
+				os_.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+				os_.open(path, std::ios::binary | std::ios::trunc);
+			}
+
+			void Write(const uint64_t* record) {
+				os_.write(reinterpret_cast<const char*>(record), static_cast<std::streamsize>(width_ * sizeof(uint64_t)));
+				++count_;
+			}
+
+			uint64_t count() const {
+				return count_;
+			}
+
+			void Close() {
+				os_.close();
+			}
+		};
+
+		/*
+		 * @brief Sequential reader of fixed-width records of uint64 words
+		 */
+		class RecordReader {
+		private:
+			std::ifstream is_;
+			std::vector<uint64_t> record_;
+			bool valid_ = false;
+		public:
+			RecordReader(const std::filesystem::path& path, size_t width)
+				: is_(path, std::ios::binary), record_(width) {
+				if (!is_) {
+					throw std::runtime_error("Could not open " + path.string());
+				}
+				Next();
+			}
+
+			bool valid() const {
+				return valid_;
+			}
+
+			const uint64_t* record() const {
+				return record_.data();
+			}
+
+			void Next() {
+				std::streamsize size = static_cast<std::streamsize>(record_.size() * sizeof(uint64_t));
+				is_.read(reinterpret_cast<char*>(record_.data()), size);
+				valid_ = (is_.gcount() == size);
+			}
+		};
+
+		/*
+		 * @brief Sorts records larger than memory: sorted runs of at most the budget are spilled to disk and
+		 * k-way merged on Finish.
+		 */
+		class ExternalSorter {
+		private:
+			std::filesystem::path directory_;
+			std::string name_;
+			size_t width_;
+			size_t key_offset_;
+			size_t key_width_;
+			size_t max_records_;
+			size_t max_fan_in_;
+			size_t num_files_ = 0;
+			std::vector<uint64_t> buffer_;
+			std::vector<std::filesystem::path> runs_;
+		public:
+			ExternalSorter(const std::filesystem::path& directory, const std::string& name, size_t width,
+				           size_t key_offset, size_t key_width, size_t memory_budget, size_t max_fan_in)
+				: directory_(directory), name_(name), width_(width), key_offset_(key_offset), key_width_(key_width),
+				  max_records_(std::max<size_t>(1, memory_budget / (width * sizeof(uint64_t)))), max_fan_in_(std::max<size_t>(2, max_fan_in)) {}
+
+			void Add(const uint64_t* record) {
+				buffer_.insert(buffer_.end(), record, record + width_);
+				if (buffer_.size() / width_ >= max_records_) {
+					Flush();
+				}
+			}
+
+			/*
+			 * @brief Merges the runs into path, keeping only the first record of every key if unique is set. While there
+			 * are more than max_fan_in runs, groups of max_fan_in are merged into longer runs first, so at most max_fan_in
+			 * runs are open at once.
+			 * @return Number of records written
+			 */
+			uint64_t Finish(const std::filesystem::path& path, bool unique) {
+				Flush();
+				while (runs_.size() > max_fan_in_) {
+					std::vector<std::filesystem::path> merged;
+					for (size_t first = 0; first < runs_.size(); first += max_fan_in_) {
+						size_t last = std::min(first + max_fan_in_, runs_.size());
+						merged.emplace_back(NextRun());
+						Merge(std::span<const std::filesystem::path>(runs_).subspan(first, last - first), merged.back(), unique);
+					}
+					runs_ = std::move(merged);
+				}
+				uint64_t count = Merge(runs_, path, unique);
+				runs_.clear();
+				return count;
+			}
+		private:
+			std::filesystem::path NextRun() {
+				return directory_ / (name_ + "-run" + std::to_string(num_files_++));
+			}
+
+			/*
+			 * @brief k-way merge of runs into path, removing the runs afterwards
+			 */
+			uint64_t Merge(std::span<const std::filesystem::path> runs, const std::filesystem::path& path, bool unique) {
+				std::vector<std::unique_ptr<RecordReader>> readers;
+				for (const auto& run : runs) {
+					readers.emplace_back(std::make_unique<RecordReader>(run, width_));
+				}
+				auto greater = [this, &readers](size_t lhs, size_t rhs) {
+					return Less(readers[rhs]->record(), readers[lhs]->record(), key_offset_, key_width_);
+				};
+				std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heap(greater);
+				for (size_t r = 0; r < readers.size(); ++r) {
+					if (readers[r]->valid()) {
+						heap.push(r);
+					}
+				}
+
+				RecordWriter writer(path, width_);
+				std::vector<uint64_t> last(width_);
+				while (!heap.empty()) {
+					size_t r = heap.top();
+					heap.pop();
+					const uint64_t* record = readers[r]->record();
+					if (!unique || writer.count() == 0 || !Equal(record, last.data(), key_offset_, key_width_)) {
+						writer.Write(record);
+						std::copy(record, record + width_, last.begin());
+					}
+					readers[r]->Next();
+					if (readers[r]->valid()) {
+						heap.push(r);
+					}
+				}
+				writer.Close();
+				readers.clear();
+				for (const auto& run : runs) {
+					std::filesystem::remove(run);
+				}
+				return writer.count();
+			}
+
+			void Flush() {
+				size_t num_records = buffer_.size() / width_;
+				if (num_records == 0) {
+					return;
+				}
+				std::vector<uint32_t> order(num_records);
+				for (uint32_t r = 0; r < num_records; ++r) {
+					order[r] = r;
+				}
+				std::stable_sort(order.begin(), order.end(), [this](uint32_t lhs, uint32_t rhs) {
+					return Less(buffer_.data() + lhs * width_, buffer_.data() + rhs * width_, key_offset_, key_width_);
+				});
+				runs_.emplace_back(NextRun());
+				RecordWriter writer(runs_.back(), width_);
+				for (uint32_t r : order) {
+					writer.Write(buffer_.data() + r * width_);
+				}
+				writer.Close();
+				buffer_.clear();
+			}
+		};
+
+		void CopyFile(std::ofstream& os, const std::filesystem::path& path) {
+			std::ifstream is(path, std::ios::binary);
+			std::vector<char> buffer(1 << 16);
+			while (is.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || is.gcount() > 0) {
+				os.write(buffer.data(), is.gcount());
+			}
+		}
+
+		void WritePadding(std::ofstream& os, size_t size) {
+			static constexpr char zeros[8] = {};
+			os.write(zeros, static_cast<std::streamsize>((8 - (size % 8)) % 8));
+		}
+
+	}
+
+	/*
+	 * @brief Computes the complete topology level by level on disk and writes it as a snapshot, see MappedTopology.
+	 *
+	 * Every BFS level streams the frontier file, writing the edges in order and the successors to an external sorter.
+	 * The sorted, deduplicated successors are merged against the sorted visited file: the ones not seen before become
+	 * the next frontier and get the next ids, so ids are assigned in BFS order with the initial state as 0. Finally the
+	 * edges are sorted by target and merge-joined with the visited file to turn target keys into ids.
+	 * Only the sort buffers, bounded by memory_budget, and the labels are held in memory, and every sort merges at most
+	 * max_fan_in runs at once so the number of open files stays bounded however many runs the budget produces.
+	 * @param max_fan_in: @default = kExternalMaxFanIn. Runs merged per pass, at least 2
+	 * @exception Propagates std::ofstream::failure and std::runtime_error on I/O errors
+	 */
+	void BuildExternalTopology(std::shared_ptr<const std::vector<ResourceAutomaton>> automata, const std::filesystem::path& snapshot,
+		                       size_t memory_budget, size_t max_fan_in) {
+		SuccessorGenerator generator(automata);
+		const size_t W = generator.codec().NumOfWords();
+
+		CreateDirectoryForPath(snapshot);
+		std::filesystem::path work = snapshot;
+		work += ".work";
+		std::filesystem::create_directories(work);
+
+		// Records: keys [key], frontier [key], visited [key, id], raw edges [seq, from, resource << 32 | label, to key]
+		RecordWriter keys(work / "keys", W);
+		RecordWriter edges(work / "edges", 3 + W);
+		std::vector<ParameterizedOp> labels;
+		std::unordered_map<uint32_t, uint32_t> label_ids;
+
+		std::vector<uint64_t> record(W + 3, 0);
+		keys.Write(record.data());
+		{
+			RecordWriter frontier(work / "frontier", W);
+			frontier.Write(record.data());
+			RecordWriter visited(work / "visited", W + 1);
+			visited.Write(record.data());
+		}
+
+		uint64_t num_states = 1;
+		uint64_t frontier_size = 1;
+		uint64_t first_id = 0;
+		uint64_t seq = 0;
+		std::vector<uint64_t> edge(3 + W);
+		while (frontier_size > 0) {
+			ExternalSorter successors(work, "successors", W, 0, W, memory_budget, max_fan_in);
+			uint64_t from = first_id;
+			for (RecordReader frontier(work / "frontier", W); frontier.valid(); frontier.Next(), ++from) {
+				PackedState key(W);
+				for (size_t w = 0; w < W; ++w) {
+					key.set_word(w, frontier.record()[w]);
+				}
+				for (const Successor& successor : generator.Successors(key)) {
+					auto [label_it, new_label] = label_ids.try_emplace(successor.label->id(), static_cast<uint32_t>(labels.size()));
+					if (new_label) {
+						labels.emplace_back(*successor.label);
+					}
+					edge[0] = seq++;
+					edge[1] = from;
+					edge[2] = (static_cast<uint64_t>(successor.resource) << 32) | label_it->second;
+					for (size_t w = 0; w < W; ++w) {
+						edge[3 + w] = successor.state.word(w);
+					}
+					edges.Write(edge.data());
+					successors.Add(edge.data() + 3);
+				}
+			}
+			first_id += frontier_size;
+			successors.Finish(work / "successors", true);
+
+			// Successors not in visited are the next frontier, merged into the next visited file
+			RecordWriter next_frontier(work / "frontier-next", W);
+			RecordWriter next_visited(work / "visited-next", W + 1);
+			{
+				RecordReader candidates(work / "successors", W);
+				RecordReader visited(work / "visited", W + 1);
+				while (candidates.valid()) {
+					while (visited.valid() && Less(visited.record(), candidates.record(), 0, W)) {
+						next_visited.Write(visited.record());
+						visited.Next();
+					}
+					if (visited.valid() && Equal(visited.record(), candidates.record(), 0, W)) {
+						candidates.Next();
+						continue;
+					}
+					std::copy(candidates.record(), candidates.record() + W, record.begin());
+					record[W] = num_states++;
+					keys.Write(record.data());
+					next_frontier.Write(record.data());
+					next_visited.Write(record.data());
+					candidates.Next();
+				}
+				for (; visited.valid(); visited.Next()) {
+					next_visited.Write(visited.record());
+				}
+			}
+			next_frontier.Close();
+			next_visited.Close();
+			frontier_size = next_frontier.count();
+			std::filesystem::rename(work / "frontier-next", work / "frontier");
+			std::filesystem::rename(work / "visited-next", work / "visited");
+		}
+		keys.Close();
+		edges.Close();
+
+		// Resolve edge targets to ids, then restore the order the edges were produced in
+		{
+			ExternalSorter by_target(work, "by-target", 3 + W, 3, W, memory_budget, max_fan_in);
+			for (RecordReader reader(work / "edges", 3 + W); reader.valid(); reader.Next()) {
+				by_target.Add(reader.record());
+			}
+			by_target.Finish(work / "edges", false);
+
+			ExternalSorter by_seq(work, "by-seq", 4, 0, 1, memory_budget, max_fan_in);
+			RecordReader visited(work / "visited", W + 1);
+			std::vector<uint64_t> resolved(4);
+			for (RecordReader reader(work / "edges", 3 + W); reader.valid(); reader.Next()) {
+				while (visited.valid() && Less(visited.record(), reader.record() + 3, 0, W)) {
+					visited.Next();
+				}
+				if (!visited.valid() || !Equal(visited.record(), reader.record() + 3, 0, W)) {
+					throw std::runtime_error("Edge target missing from the visited states");
+				}
+				std::copy(reader.record(), reader.record() + 3, resolved.begin());
+				resolved[3] = visited.record()[W];
+				by_seq.Add(resolved.data());
+			}
+			by_seq.Finish(work / "edges", false);
+		}
+
+		std::string encoded_labels = EncodeSnapshotLabels(labels);
+		SnapshotHeader header{};
+		std::memcpy(header.magic, SnapshotHeader::kMagic, sizeof(header.magic));
+		header.version = SnapshotHeader::kVersion;
+		header.byte_order = SnapshotHeader::kByteOrder;
+		header.num_words = static_cast<uint32_t>(W);
+		header.resources_hash = ResourcesHash(*automata);
+		header.num_states = num_states;
+		header.num_edges = seq;
+		header.num_labels = labels.size();
+		header.labels_size = encoded_labels.size();
+
+		std::ofstream os(snapshot, std::ios::binary | std::ios::trunc);
+		os.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+		os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		CopyFile(os, work / "keys");
+		for (RecordReader visited(work / "visited", W + 1); visited.valid(); visited.Next()) {
+			uint32_t id = static_cast<uint32_t>(visited.record()[W]);
+			os.write(reinterpret_cast<const char*>(&id), sizeof(id));
+		}
+		WritePadding(os, num_states * sizeof(uint32_t));
+
+		uint64_t offset = 0;
+		uint64_t id = 0;
+		os.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+		for (RecordReader reader(work / "edges", 4); reader.valid(); reader.Next(), ++offset) {
+			for (; id < reader.record()[1]; ++id) {
+				os.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+			}
+		}
+		for (; id < num_states; ++id) {
+			os.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+		}
+
+		for (RecordReader reader(work / "edges", 4); reader.valid(); reader.Next()) {
+			FrozenTopology::Edge frozen_edge{ static_cast<uint32_t>(reader.record()[2] >> 32), static_cast<uint32_t>(reader.record()[2]),
+				                              static_cast<uint32_t>(reader.record()[3]) };
+			os.write(reinterpret_cast<const char*>(&frozen_edge), sizeof(frozen_edge));
+		}
+		WritePadding(os, seq * sizeof(FrozenTopology::Edge));
+		os.write(encoded_labels.data(), static_cast<std::streamsize>(encoded_labels.size()));
+		os.close();
+
+		std::filesystem::remove_all(work);
+	}
+
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <filesystem>
+
+#include "pcs/topology/resource_automaton.h"
+
+namespace pcs {
+
+	/*
+	 * @brief Default amount of memory the external construction may use for its sort buffers
+	 */
+	inline constexpr size_t kExternalMemoryBudget = size_t(256) << 20;
+
+	/*
+	 * @brief Default number of sorted runs the external construction merges at once, each holds an open file
+	 */
+	inline constexpr size_t kExternalMaxFanIn = 64;
+
+	void BuildExternalTopology(std::shared_ptr<const std::vector<ResourceAutomaton>> automata, const std::filesystem::path& snapshot,
+		                       size_t memory_budget = kExternalMemoryBudget, size_t max_fan_in = kExternalMaxFanIn);
+
+}
@@ -0,0 +1,198 @@
+#include "pcs/topology/frozen.h"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <utility>
+#include <optional>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "lts/lts.h"
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/state_codec.h"
+#include "pcs/topology/delta_store.h"
+#include "pcs/topology/resource_automaton.h"
+
+namespace pcs {
+
+	/*
+	 * @param keys: states in BFS order from the initial state, state id i is keys[i]
+	 * @param checkpoint_interval: @default = 1. See DeltaStateStore, 1 stores every state in full
+	 * @exception Throws std::invalid_argument if a state occurs twice in keys
+	 */
+	FrozenTopology::FrozenTopology(std::shared_ptr<const std::vector<ResourceAutomaton>> automata, std::vector<PackedState>&& keys,
+		std::vector<uint64_t>&& offsets, std::vector<Edge>&& edges, std::vector<ParameterizedOp>&& labels, uint32_t checkpoint_interval)
+		: automata_(std::move(automata)), codec_(automata_), states_(automata_, checkpoint_interval), offsets_(std::move(offsets)),
+		  edges_(std::move(edges)), labels_(std::move(labels)), is_materialised_(keys.size(), 0) {
+		std::vector<PackedState> frozen_keys = std::move(keys);
+		// The first edge into a state from a lower id is from the state that discovered it, its delta is taken against that one
+		std::vector<uint32_t> parents(frozen_keys.size(), DeltaStateStore::kNone);
+		for (uint32_t id = 0; id < frozen_keys.size(); ++id) {
+			for (const auto& edge : this->edges(id)) {
+				if (edge.to > id && parents[edge.to] == DeltaStateStore::kNone) {
+					parents[edge.to] = id;
+				}
+			}
+		}
+		for (uint32_t id = 0; id < frozen_keys.size(); ++id) {
+			if (!states_.Intern(frozen_keys[id], parents[id]).second) {
+				throw std::invalid_argument("Duplicate state in frozen topology");
+			}
+		}
+		materialised_.set_initial_state(Key(0));
+	}
+
+	/*
+	 * @brief Renders the full LTS on the first call, transitions of every state keep the order they were frozen in.
+	 */
+	const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& FrozenTopology::lts() const {
+		if (!lts_) {
+			lts_ = std::make_unique<nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>>();
+			lts_->set_initial_state(Key(0));
+			std::vector<std::string> from;
+			for (uint32_t id = 0; id < states_.size(); ++id) {
+				codec_.Decode(states_.Decode(id), from);
+				for (const auto& edge : edges(id)) {
+					lts_->AddTransition(from, std::make_pair(static_cast<size_t>(edge.resource), labels_[edge.label]), Key(edge.to));
+				}
+			}
+		}
+		return *lts_;
+	}
+
+	FrozenTopology::operator const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& () const {
+		return lts();
+	}
+
+	const std::vector<std::string>& FrozenTopology::initial_state() const {
+		return materialised_.initial_state();
+	}
+
+	/*
+	 * @brief Renders the transitions of a single state the first time it is asked for.
+	 * @exception Throws std::out_of_range if key is not a state of the topology
+	 */
+	const nightly::State<std::vector<std::string>, std::pair<size_t, ParameterizedOp>>& FrozenTopology::at(const std::vector<std::string>& key) {
+		uint32_t id = Id(key);
+		if (is_materialised_[id] == 0) {
+			for (const auto& edge : edges(id)) {
+				materialised_.AddTransition(key, std::make_pair(static_cast<size_t>(edge.resource), labels_[edge.label]), Key(edge.to));
+			}
+			is_materialised_[id] = 1;
+		}
+		return materialised_.states().at(key);
+	}
+
+	bool FrozenTopology::IsDead(const std::vector<std::string>& key) const {
+		if (dead_.empty()) {
+			return false;
+		}
+		std::optional<uint32_t> id = states_.Find(codec_.Encode(key));
+		return id.has_value() && dead_[*id] != 0;
+	}
+
+	/*
+	 * @brief Marks the states that cannot reach a goal state, by backward reachability from the goals over reversed edges.
+	 * A goal state is one where an operation of the set can be executed: an observable transition with that operation
+	 * while every other resource can nop. With an empty set the goals are the states where every resource can nop.
+	 * Successors of a dead state are dead, so the dead transitions are exactly the transitions into dead states.
+	 */
+	PruneReport FrozenTopology::Prune(const std::unordered_set<uint32_t>& operations) {
+		const size_t num_states = states_.size();
+		std::vector<uint64_t> reverse_offsets(num_states + 1, 0);
+		for (const auto& edge : edges_) {
+			++reverse_offsets[edge.to + 1];
+		}
+		for (size_t id = 0; id < num_states; ++id) {
+			reverse_offsets[id + 1] += reverse_offsets[id];
+		}
+		std::vector<uint32_t> sources(edges_.size());
+		std::vector<uint64_t> fill(reverse_offsets.begin(), reverse_offsets.end() - 1);
+		for (uint32_t id = 0; id < num_states; ++id) {
+			for (const auto& edge : edges(id)) {
+				sources[fill[edge.to]++] = id;
+			}
+		}
+
+		std::vector<uint8_t> live(num_states, 0);
+		std::vector<uint32_t> queue;
+		for (uint32_t id = 0; id < num_states; ++id) {
+			PackedState key = states_.Decode(id);
+			size_t num_busy = 0;
+			size_t busy = 0;
+			for (size_t i = 0; i < automata_->size(); ++i) {
+				if (!(*automata_)[i].HasNop(codec_.Get(key, i))) {
+					++num_busy;
+					busy = i;
+				}
+			}
+			bool goal = false;
+			if (operations.empty()) {
+				goal = (num_busy == 0);
+			} else if (num_busy <= 1) {
+				for (const auto& edge : edges(id)) {
+					const ParameterizedOp& label = labels_[edge.label];
+					if ((num_busy == 0 || edge.resource == busy) && label.IsObservable() && operations.contains(label.operation_id())) {
+						goal = true;
+						break;
+					}
+				}
+			}
+			if (goal) {
+				live[id] = 1;
+				queue.emplace_back(id);
+			}
+		}
+		for (size_t head = 0; head < queue.size(); ++head) {
+			uint32_t id = queue[head];
+			for (uint64_t e = reverse_offsets[id]; e < reverse_offsets[id + 1]; ++e) {
+				if (live[sources[e]] == 0) {
+					live[sources[e]] = 1;
+					queue.emplace_back(sources[e]);
+				}
+			}
+		}
+
+		PruneReport report;
+		report.num_states = num_states;
+		report.num_transitions = edges_.size();
+		dead_.assign(num_states, 0);
+		for (uint32_t id = 0; id < num_states; ++id) {
+			if (live[id] == 0) {
+				dead_[id] = 1;
+				++report.num_dead_states;
+				report.num_dead_transitions += reverse_offsets[id + 1] - reverse_offsets[id];
+			}
+		}
+		return report;
+	}
+
+	size_t FrozenTopology::NumOfStates() const {
+		return states_.size();
+	}
+
+	size_t FrozenTopology::NumOfTransitions() const {
+		return edges_.size();
+	}
+
+	size_t FrozenTopology::NumOfLabels() const {
+		return labels_.size();
+	}
+
+	/*
+	 * @exception Throws std::out_of_range if key is not a state of the topology
+	 */
+	uint32_t FrozenTopology::Id(const std::vector<std::string>& key) const {
+		std::optional<uint32_t> id = states_.Find(codec_.Encode(key));
+		if (!id.has_value()) {
+			throw std::out_of_range("State is not in the topology");
+		}
+		return *id;
+	}
+
+	std::vector<std::string> FrozenTopology::Key(uint32_t id) const {
+		return codec_.Names(states_.Decode(id));
+	}
+
+}
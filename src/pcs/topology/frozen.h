@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <span>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+
+#include <boost/container_hash/hash.hpp>
+
+#include "lts/lts.h"
+#include "pcs/topology/topology.h"
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/state_codec.h"
+#include "pcs/topology/delta_store.h"
+#include "pcs/topology/resource_automaton.h"
+
+namespace pcs {
+
+	/*
+	 * @brief: Outcome of FrozenTopology::Prune, dead transitions are the ones into dead states
+	 */
+	struct PruneReport {
+		size_t num_states = 0;
+		size_t num_dead_states = 0;
+		size_t num_transitions = 0;
+		size_t num_dead_transitions = 0;
+	};
+
+	/**
+	 * @brief Immutable compressed-sparse-row form of a complete topology, see CompleteTopology::Freeze.
+	 *
+	 * States are numbered in BFS order from the initial state (id 0), the edges of state s are
+	 * [offsets[s], offsets[s + 1]) in the edge array and every edge is a (resource, label id, target id) triple.
+	 * at() and lts() render the nightly::LTS view on demand: at() only for the states that are asked for, lts() in full
+	 * on its first call. After Prune, IsDead reports the states from which no recipe operation can be reached.
+	 * States are kept in a DeltaStateStore, as deltas from the state that discovered them when checkpoint_interval > 1
+	 * and the states are wide enough for deltas to take less memory, see DeltaStateStore::Pays.
+	 */
+	class FrozenTopology : public ITopology {
+	public:
+		struct Edge {
+			uint32_t resource;
+			uint32_t label;
+			uint32_t to;
+		};
+	private:
+		std::shared_ptr<const std::vector<ResourceAutomaton>> automata_;
+		StateCodec codec_;
+
+		DeltaStateStore states_;
+		std::vector<uint64_t> offsets_;
+		std::vector<Edge> edges_;
+		std::vector<ParameterizedOp> labels_;
+
+		nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>> materialised_;
+		std::vector<uint8_t> is_materialised_;
+		std::vector<uint8_t> dead_;
+		mutable std::unique_ptr<nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>> lts_;
+	public:
+		FrozenTopology(std::shared_ptr<const std::vector<ResourceAutomaton>> automata, std::vector<PackedState>&& keys,
+			std::vector<uint64_t>&& offsets, std::vector<Edge>&& edges, std::vector<ParameterizedOp>&& labels, uint32_t checkpoint_interval = 1);
+
+		const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& lts() const override;
+		operator const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& () const override;
+		const std::vector<std::string>& initial_state() const override;
+		const nightly::State<std::vector<std::string>, std::pair<size_t, ParameterizedOp>>& at(const std::vector<std::string>& key) override;
+		bool IsDead(const std::vector<std::string>& key) const override;
+
+		PruneReport Prune(const std::unordered_set<uint32_t>& operations);
+		size_t NumOfStates() const override;
+		size_t NumOfTransitions() const;
+		size_t NumOfLabels() const;
+		uint32_t Id(const std::vector<std::string>& key) const;
+		std::vector<std::string> Key(uint32_t id) const;
+
+		const std::shared_ptr<const std::vector<ResourceAutomaton>>& automata() const {
+			return automata_;
+		}
+
+		const StateCodec& codec() const {
+			return codec_;
+		}
+
+		PackedState packed(uint32_t id) const {
+			return states_.Decode(id);
+		}
+
+		const DeltaStateStore& states() const {
+			return states_;
+		}
+
+		std::span<const Edge> edges(uint32_t id) const {
+			return { edges_.data() + offsets_[id], edges_.data() + offsets_[id + 1] };
+		}
+
+		const ParameterizedOp& label(uint32_t id) const {
+			return labels_[id];
+		}
+	};
+
+}
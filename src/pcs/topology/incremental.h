@@ -3,27 +3,34 @@
 
 #include <vector>
 #include <string>
+#include <memory>
 
 #include <boost/container_hash/hash.hpp>
 
 #include "lts/lts.h"
 #include "pcs/topology/core.h"
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/packed_state_set.h"
+#include "pcs/topology/state_codec.h"
+#include "pcs/topology/resource_automaton.h"
+#include "pcs/topology/successors.h"
 
 namespace pcs {
 
 	class IncrementalTopology : public ITopology {
 	private:
 		nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>> topology_;
-		std::unordered_set<std::vector<std::string>, boost::hash<std::vector<std::string>>> visited_;
-		const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss_;
+		PackedStateSet visited_;
+		SuccessorGenerator generator_;
 	public:
 		IncrementalTopology(const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss);
+		IncrementalTopology(std::shared_ptr<const std::vector<ResourceAutomaton>> automata);
 		const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& lts() const override;
 		operator const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& () const override;
 		const std::vector<std::string>& initial_state() const override;
 		const nightly::State<std::vector<std::string>, std::pair<size_t, ParameterizedOp>>& at(const std::vector<std::string>& key) override;
 	private:
-		void ExpandState(const std::vector<std::string>& key);
+		void ExpandState(const std::vector<std::string>& key, const PackedState& packed_key);
 
 	};
 
@@ -0,0 +1,113 @@
+#include "pcs/topology/influence.h"
+
+#include <vector>
+#include <map>
+#include <numeric>
+#include <algorithm>
+#include <unordered_set>
+
+#include "pcs/operation/transfer.h"
+#include "pcs/topology/resource_automaton.h"
+
+namespace pcs {
+
+	namespace {
+
+		size_t Find(std::vector<size_t>& parent, size_t i) {
+			while (parent[i] != i) {
+				parent[i] = parent[parent[i]];
+				i = parent[i];
+			}
+			return i;
+		}
+
+	}
+
+	/*
+	 * @brief Partitions the resources into groups that synchronise with each other: two resources are in the same group
+	 * when one offers a transfer and the other its inverse, directly or through other resources of the group.
+	 * Groups are ordered by their lowest resource and list their resources in ascending order.
+	 */
+	std::vector<std::vector<size_t>> TransferGroups(const std::vector<ResourceAutomaton>& automata) {
+		std::vector<size_t> parent(automata.size());
+		std::iota(parent.begin(), parent.end(), 0);
+		// Per transfer number, the resources offering in:n and the ones offering out:n
+		std::map<size_t, std::pair<std::vector<size_t>, std::vector<size_t>>> transfers;
+
+		for (size_t i = 0; i < automata.size(); ++i) {
+			const ResourceAutomaton& automaton = automata[i];
+			for (uint32_t s = 0; s < automaton.NumOfStates(); ++s) {
+				for (const auto& label : automaton.labels(s)) {
+					if (!label.IsTransfer()) {
+						continue;
+					}
+					auto& [ins, outs] = transfers[label.transfer_n()];
+					auto& side = (label.transfer_type() == TransferType::in) ? ins : outs;
+					if (side.empty() || side.back() != i) {
+						side.emplace_back(i);
+					}
+				}
+			}
+		}
+
+		for (const auto& [n, sides] : transfers) {
+			const auto& [ins, outs] = sides;
+			if (ins.empty() || outs.empty()) {
+				continue;
+			}
+			for (size_t i : ins) {
+				parent[Find(parent, i)] = Find(parent, outs.front());
+			}
+			for (size_t i : outs) {
+				parent[Find(parent, i)] = Find(parent, outs.front());
+			}
+		}
+
+		std::vector<std::vector<size_t>> groups;
+		std::vector<size_t> group_of(automata.size(), automata.size());
+		for (size_t i = 0; i < automata.size(); ++i) {
+			size_t root = Find(parent, i);
+			if (group_of[root] == automata.size()) {
+				group_of[root] = groups.size();
+				groups.emplace_back();
+			}
+			groups[group_of[root]].emplace_back(i);
+		}
+		return groups;
+	}
+
+	/*
+	 * @brief Resources that can matter to a recipe with the given operation ids, in ascending order.
+	 *
+	 * A transfer group (see TransferGroups) is kept when one of its resources offers an operation of the recipe, or
+	 * when one of them cannot nop in its initial state (holding it there would block every operation). The other
+	 * resources can be held in their initial state, where they can nop, without changing which recipe operations are
+	 * reachable.
+	 */
+	std::vector<size_t> RelevantResources(const std::vector<ResourceAutomaton>& automata, const std::unordered_set<uint32_t>& operations) {
+		std::vector<size_t> relevant;
+		for (const auto& group : TransferGroups(automata)) {
+			bool is_relevant = false;
+			for (size_t i : group) {
+				const ResourceAutomaton& automaton = automata[i];
+				if (!automaton.HasNop(0)) {
+					is_relevant = true;
+				}
+				for (uint32_t s = 0; s < automaton.NumOfStates() && !is_relevant; ++s) {
+					for (const auto& label : automaton.labels(s)) {
+						if (label.IsObservable() && operations.contains(label.operation_id())) {
+							is_relevant = true;
+							break;
+						}
+					}
+				}
+			}
+			if (is_relevant) {
+				relevant.insert(relevant.end(), group.begin(), group.end());
+			}
+		}
+		std::sort(relevant.begin(), relevant.end());
+		return relevant;
+	}
+
+}
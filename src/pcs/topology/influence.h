@@ -0,0 +1,14 @@
+#pragma once
+
+#include <vector>
+#include <unordered_set>
+#include <cstdint>
+
+#include "pcs/topology/resource_automaton.h"
+
+namespace pcs {
+
+	std::vector<std::vector<size_t>> TransferGroups(const std::vector<ResourceAutomaton>& automata);
+	std::vector<size_t> RelevantResources(const std::vector<ResourceAutomaton>& automata, const std::unordered_set<uint32_t>& operations);
+
+}
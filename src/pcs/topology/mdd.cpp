@@ -0,0 +1,155 @@
+#include "pcs/topology/mdd.h"
+
+#include <vector>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <algorithm>
+
+namespace pcs {
+
+	Mdd::Mdd(std::vector<uint32_t> domains)
+		: domains_(std::move(domains)) {
+		uint32_t terminal_level = static_cast<uint32_t>(domains_.size());
+		nodes_.push_back({ terminal_level, 0 });
+		nodes_.push_back({ terminal_level, 0 });
+	}
+
+	size_t Mdd::NumOfLevels() const {
+		return domains_.size();
+	}
+
+	size_t Mdd::NumOfNodes() const {
+		return nodes_.size();
+	}
+
+	uint32_t Mdd::domain(size_t level) const {
+		return domains_[level];
+	}
+
+	/*
+	 * @brief The set holding only the given tuple
+	 */
+	uint32_t Mdd::Singleton(std::span<const uint32_t> values) {
+		uint32_t node = kTerminal;
+		for (size_t level = domains_.size(); level-- > 0;) {
+			std::vector<uint32_t> children(domains_[level], kEmpty);
+			children[values[level]] = node;
+			node = Make(static_cast<uint32_t>(level), std::move(children));
+		}
+		return node;
+	}
+
+	uint32_t Mdd::Union(uint32_t lhs, uint32_t rhs) {
+		std::unordered_map<uint64_t, uint32_t> cache;
+		return Union(lhs, rhs, cache);
+	}
+
+	/*
+	 * @brief Successors of the tuples of set under the relation
+	 */
+	uint32_t Mdd::Image(uint32_t set, const Relation& relation) {
+		std::unordered_map<uint32_t, uint32_t> cache;
+		std::unordered_map<uint64_t, uint32_t> union_cache;
+		return Image(set, relation, cache, union_cache);
+	}
+
+	bool Mdd::Contains(uint32_t set, std::span<const uint32_t> values) const {
+		uint32_t node = set;
+		for (size_t level = 0; level < domains_.size() && node != kEmpty; ++level) {
+			node = child(node, values[level]);
+		}
+		return node == kTerminal;
+	}
+
+	/*
+	 * @brief Number of tuples in the set, as a double since it may exceed 64 bits
+	 */
+	double Mdd::Count(uint32_t set) const {
+		std::vector<double> counts(nodes_.size(), -1.0);
+		counts[kEmpty] = 0.0;
+		counts[kTerminal] = 1.0;
+		auto count = [this, &counts](auto& self, uint32_t node) -> double {
+			if (counts[node] >= 0.0) {
+				return counts[node];
+			}
+			double total = 0.0;
+			for (uint32_t value = 0; value < domains_[nodes_[node].level]; ++value) {
+				total += self(self, child(node, value));
+			}
+			counts[node] = total;
+			return total;
+		};
+		return count(count, set);
+	}
+
+	/*
+	 * @brief Returns the unique node with these children, the empty set if they are all empty
+	 */
+	uint32_t Mdd::Make(uint32_t level, std::vector<uint32_t>&& children) {
+		if (std::all_of(children.begin(), children.end(), [](uint32_t c) { return c == kEmpty; })) {
+			return kEmpty;
+		}
+		children.push_back(level);
+		auto [it, inserted] = unique_.try_emplace(std::move(children), static_cast<uint32_t>(nodes_.size()));
+		if (inserted) {
+			nodes_.push_back({ level, static_cast<uint32_t>(children_.size()) });
+			children_.insert(children_.end(), it->first.begin(), it->first.end() - 1);
+		}
+		return it->second;
+	}
+
+	uint32_t Mdd::Union(uint32_t lhs, uint32_t rhs, std::unordered_map<uint64_t, uint32_t>& cache) {
+		if (lhs == kEmpty || lhs == rhs) {
+			return rhs;
+		}
+		if (rhs == kEmpty) {
+			return lhs;
+		}
+		if (lhs > rhs) {
+			std::swap(lhs, rhs);
+		}
+		uint64_t key = (static_cast<uint64_t>(lhs) << 32) | rhs;
+		if (auto it = cache.find(key); it != cache.end()) {
+			return it->second;
+		}
+		uint32_t level = nodes_[lhs].level;
+		std::vector<uint32_t> children(domains_[level]);
+		for (uint32_t value = 0; value < domains_[level]; ++value) {
+			children[value] = Union(child(lhs, value), child(rhs, value), cache);
+		}
+		uint32_t result = Make(level, std::move(children));
+		cache.emplace(key, result);
+		return result;
+	}
+
+	uint32_t Mdd::Image(uint32_t set, const Relation& relation, std::unordered_map<uint32_t, uint32_t>& cache,
+		                std::unordered_map<uint64_t, uint32_t>& union_cache) {
+		if (set == kEmpty || set == kTerminal || nodes_[set].level > relation.last_level) {
+			return set;
+		}
+		if (auto it = cache.find(set); it != cache.end()) {
+			return it->second;
+		}
+		uint32_t level = nodes_[set].level;
+		const LevelRelation* level_relation = relation.levels[level];
+		std::vector<uint32_t> children(domains_[level], kEmpty);
+		for (uint32_t value = 0; value < domains_[level]; ++value) {
+			uint32_t image = Image(child(set, value), relation, cache, union_cache);
+			if (image == kEmpty) {
+				continue;
+			}
+			if (level_relation == nullptr) {
+				children[value] = image;
+				continue;
+			}
+			for (uint32_t to : level_relation->successors[value]) {
+				children[to] = Union(children[to], image, union_cache);
+			}
+		}
+		uint32_t result = Make(level, std::move(children));
+		cache.emplace(set, result);
+		return result;
+	}
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <unordered_map>
+#include <cstdint>
+
+#include <boost/container_hash/hash.hpp>
+
+namespace pcs {
+
+	/**
+	 * @brief Quasi-reduced multi-valued decision diagrams over a fixed sequence of finite-domain variables.
+	 *
+	 * Every path from a root visits each level once, level l has one child per value of variable l. Nodes are
+	 * hash-consed, so two diagrams denote the same set iff they are the same node. Node 0 is the empty set and node 1
+	 * the terminal below the last level. Nodes are never freed, a manager lives as long as the diagrams it built.
+	 */
+	class Mdd {
+	public:
+		static constexpr uint32_t kEmpty = 0;
+		static constexpr uint32_t kTerminal = 1;
+
+		/*
+		 * @brief: Relation on the variables of one level, value v may move to any of successors[v]
+		 */
+		struct LevelRelation {
+			std::vector<std::vector<uint32_t>> successors;
+		};
+
+		/*
+		 * @brief: Product of level relations, the levels without a relation keep their value
+		 */
+		struct Relation {
+			std::vector<const LevelRelation*> levels;
+			size_t last_level = 0;
+		};
+	private:
+		struct Node {
+			uint32_t level;
+			uint32_t offset;
+		};
+
+		std::vector<uint32_t> domains_;
+		std::vector<Node> nodes_;
+		std::vector<uint32_t> children_;
+		std::unordered_map<std::vector<uint32_t>, uint32_t, boost::hash<std::vector<uint32_t>>> unique_;
+	public:
+		Mdd(std::vector<uint32_t> domains);
+
+		size_t NumOfLevels() const;
+		size_t NumOfNodes() const;
+		uint32_t domain(size_t level) const;
+
+		uint32_t Singleton(std::span<const uint32_t> values);
+		uint32_t Union(uint32_t lhs, uint32_t rhs);
+		uint32_t Image(uint32_t set, const Relation& relation);
+		bool Contains(uint32_t set, std::span<const uint32_t> values) const;
+		double Count(uint32_t set) const;
+
+		uint32_t child(uint32_t node, uint32_t value) const {
+			return children_[nodes_[node].offset + value];
+		}
+	private:
+		uint32_t Make(uint32_t level, std::vector<uint32_t>&& children);
+		uint32_t Union(uint32_t lhs, uint32_t rhs, std::unordered_map<uint64_t, uint32_t>& cache);
+		uint32_t Image(uint32_t set, const Relation& relation, std::unordered_map<uint32_t, uint32_t>& cache,
+			           std::unordered_map<uint64_t, uint32_t>& union_cache);
+	};
+
+}
@@ -0,0 +1,15 @@
+#include "pcs/topology/packed_state.h"
+
+#include <vector>
+#include <cstdint>
+
+namespace pcs {
+
+	PackedState::PackedState(size_t num_words)
+		: num_words_(static_cast<uint32_t>(num_words)) {
+		if (num_words > kInlineWords) {
+			overflow_.resize(num_words - kInlineWords, 0);
+		}
+	}
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace pcs {
+
+	/**
+	 * @brief A topology state stored as a fixed-width tuple of per-resource local state ids.
+	 *
+	 * The layout of the words is decided by a StateCodec: either a single mixed-radix integer, or bit fields
+	 * spread over as many words as required. The first words are stored inline so that typical machines never allocate.
+	 */
+	class PackedState {
+	public:
+		static constexpr size_t kInlineWords = 2;
+	private:
+		std::array<uint64_t, kInlineWords> words_{};
+		std::vector<uint64_t> overflow_;
+		uint32_t num_words_ = 0;
+	public:
+		PackedState() = default;
+		explicit PackedState(size_t num_words);
+
+		size_t NumOfWords() const {
+			return num_words_;
+		}
+
+		uint64_t word(size_t idx) const {
+			return (idx < kInlineWords) ? words_[idx] : overflow_[idx - kInlineWords];
+		}
+
+		void set_word(size_t idx, uint64_t value) {
+			if (idx < kInlineWords) {
+				words_[idx] = value;
+			} else {
+				overflow_[idx - kInlineWords] = value;
+			}
+		}
+
+		size_t Hash() const {
+			uint64_t h = 0x9E3779B97F4A7C15ull ^ num_words_;
+			for (size_t i = 0; i < num_words_; ++i) {
+				uint64_t w = word(i) + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+				w = (w ^ (w >> 30)) * 0xBF58476D1CE4E5B9ull;
+				w = (w ^ (w >> 27)) * 0x94D049BB133111EBull;
+				h ^= w ^ (w >> 31);
+			}
+			return static_cast<size_t>(h);
+		}
+
+		bool operator==(const PackedState& other) const {
+			return (words_ == other.words_) && (overflow_ == other.overflow_);
+		}
+	};
+
+	struct PackedStateHash {
+		size_t operator()(const PackedState& state) const {
+			return state.Hash();
+		}
+	};
+
+}
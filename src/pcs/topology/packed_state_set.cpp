@@ -0,0 +1,172 @@
+#include "pcs/topology/packed_state_set.h"
+
+#include <vector>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PCS_PACKED_STATE_SET_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "pcs/topology/packed_state.h"
+
+namespace pcs {
+
+	namespace {
+
+		/*
+		 * @brief Bit i is set when byte i of the group of kGroupWidth control bytes starting at group equals value
+		 */
+		uint32_t MatchByte(const int8_t* group, int8_t value) {
+#if defined(PCS_PACKED_STATE_SET_SSE2)
+			__m128i control = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+			return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8(value))));
+#else
+			uint32_t mask = 0;
+			for (size_t i = 0; i < PackedStateSet::kGroupWidth; ++i) {
+				mask |= static_cast<uint32_t>(group[i] == value) << i;
+			}
+			return mask;
+#endif
+		}
+
+		int8_t Tag(uint64_t hash) {
+			return static_cast<int8_t>(hash & 0x7F);
+		}
+
+	}
+
+	size_t PackedStateSet::size() const {
+		return size_;
+	}
+
+	bool PackedStateSet::empty() const {
+		return size_ == 0;
+	}
+
+	/*
+	 * @brief Grows the table so that num_keys keys fit without rehashing
+	 */
+	void PackedStateSet::Reserve(size_t num_keys) {
+		size_t capacity = (capacity_ == 0) ? kGroupWidth : capacity_;
+		while (num_keys * 8 > capacity * 7) {
+			capacity *= 2;
+		}
+		if (capacity != capacity_) {
+			Rehash(capacity);
+		}
+	}
+
+	/*
+	 * @returns Whether key was not in the set yet
+	 */
+	bool PackedStateSet::Insert(const PackedState& key) {
+		if (size_ == 0 && num_words_ != key.NumOfWords()) {
+			num_words_ = key.NumOfWords();
+			keys_.assign(capacity_ * num_words_, 0);
+		}
+		uint64_t hash = key.Hash();
+		size_t slot;
+		if (capacity_ != 0 && Find(key, hash, &slot)) {
+			return false;
+		}
+		// Only a new key may grow the table, the slot is looked up again in the grown one
+		if (capacity_ == 0 || (size_ + 1) * 8 > capacity_ * 7) {
+			Reserve(size_ + 1);
+			Find(key, hash, &slot);
+		}
+		Place(slot, hash);
+		for (size_t w = 0; w < num_words_; ++w) {
+			keys_[slot * num_words_ + w] = key.word(w);
+		}
+		++size_;
+		return true;
+	}
+
+	bool PackedStateSet::Contains(const PackedState& key) const {
+		if (size_ == 0) {
+			return false;
+		}
+		size_t slot;
+		return Find(key, key.Hash(), &slot);
+	}
+
+	/*
+	 * @brief Probes the groups of the triangular sequence from the slot picked by the high bits of hash.
+	 * Slots whose tag matches are compared by full hash first and only then by key words.
+	 * @param slot: set to the slot of key if it is found, otherwise to the first empty slot of its probe sequence
+	 */
+	bool PackedStateSet::Find(const PackedState& key, uint64_t hash, size_t* slot) const {
+		const size_t mask = capacity_ - 1;
+		const int8_t tag = Tag(hash);
+		size_t pos = (hash >> 7) & mask;
+		for (size_t step = kGroupWidth;; step += kGroupWidth) {
+			const int8_t* group = control_.data() + pos;
+			for (uint32_t match = MatchByte(group, tag); match != 0; match &= match - 1) {
+				size_t candidate = (pos + std::countr_zero(match)) & mask;
+				if (hashes_[candidate] != hash) {
+					continue;
+				}
+				bool equal = true;
+				for (size_t w = 0; w < num_words_ && equal; ++w) {
+					equal = (keys_[candidate * num_words_ + w] == key.word(w));
+				}
+				if (equal) {
+					*slot = candidate;
+					return true;
+				}
+			}
+			uint32_t empty = MatchByte(group, kEmpty);
+			if (empty != 0) {
+				*slot = (pos + std::countr_zero(empty)) & mask;
+				return false;
+			}
+			pos = (pos + step) & mask;
+		}
+	}
+
+	void PackedStateSet::Place(size_t slot, uint64_t hash) {
+		control_[slot] = Tag(hash);
+		if (slot < kGroupWidth) {
+			control_[capacity_ + slot] = Tag(hash);
+		}
+		hashes_[slot] = hash;
+	}
+
+	/*
+	 * @brief Moves every key into a table of the given power of two capacity, using the stored hashes
+	 */
+	void PackedStateSet::Rehash(size_t capacity) {
+		std::vector<int8_t> control = std::move(control_);
+		std::vector<uint64_t> hashes = std::move(hashes_);
+		std::vector<uint64_t> keys = std::move(keys_);
+		const size_t old_capacity = capacity_;
+
+		capacity_ = capacity;
+		control_.assign(capacity_ + kGroupWidth, kEmpty);
+		hashes_.assign(capacity_, 0);
+		keys_.assign(capacity_ * num_words_, 0);
+
+		const size_t mask = capacity_ - 1;
+		for (size_t old_slot = 0; old_slot < old_capacity; ++old_slot) {
+			if (control[old_slot] == kEmpty) {
+				continue;
+			}
+			uint64_t hash = hashes[old_slot];
+			size_t pos = (hash >> 7) & mask;
+			uint32_t empty = MatchByte(control_.data() + pos, kEmpty);
+			for (size_t step = kGroupWidth; empty == 0; step += kGroupWidth) {
+				pos = (pos + step) & mask;
+				empty = MatchByte(control_.data() + pos, kEmpty);
+			}
+			size_t slot = (pos + std::countr_zero(empty)) & mask;
+			Place(slot, hash);
+			for (size_t w = 0; w < num_words_; ++w) {
+				keys_[slot * num_words_ + w] = keys[old_slot * num_words_ + w];
+			}
+		}
+	}
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "pcs/topology/packed_state.h"
+
+namespace pcs {
+
+	/**
+	 * @brief Insert-only flat hash set of PackedStates, used for the visited sets of the topology builders.
+	 *
+	 * Open addressing in the style of Swiss tables: one control byte per slot, either empty or the low 7 bits of the
+	 * hash of its key, probed 16 slots at a time (with SSE2 where available, otherwise a scalar loop). Keys are stored
+	 * inline as fixed-width word rows next to their full hash, so a probe touches no pointers and growing the table does
+	 * not hash again. All keys must have the same number of words, which is taken from the first key inserted.
+	 */
+	class PackedStateSet {
+	public:
+		static constexpr size_t kGroupWidth = 16;
+	private:
+		static constexpr int8_t kEmpty = -128;
+
+		size_t num_words_ = 0;
+		size_t size_ = 0;
+		size_t capacity_ = 0;
+		// capacity_ control bytes followed by a copy of the first kGroupWidth, so a group can be loaded at any slot
+		std::vector<int8_t> control_;
+		std::vector<uint64_t> hashes_;
+		std::vector<uint64_t> keys_;
+	public:
+		PackedStateSet() = default;
+
+		size_t size() const;
+		bool empty() const;
+		void Reserve(size_t num_keys);
+		bool Insert(const PackedState& key);
+		bool Contains(const PackedState& key) const;
+
+		/*
+		 * @brief Calls f with every key of the set, in no particular order
+		 */
+		template <typename F>
+		void ForEach(F&& f) const {
+			PackedState key(num_words_);
+			for (size_t slot = 0; slot < capacity_; ++slot) {
+				if (control_[slot] != kEmpty) {
+					for (size_t w = 0; w < num_words_; ++w) {
+						key.set_word(w, keys_[slot * num_words_ + w]);
+					}
+					f(key);
+				}
+			}
+		}
+	private:
+		bool Find(const PackedState& key, uint64_t hash, size_t* slot) const;
+		void Place(size_t slot, uint64_t hash);
+		void Rehash(size_t capacity);
+	};
+
+}
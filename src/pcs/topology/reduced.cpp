@@ -0,0 +1,127 @@
+#include "pcs/topology/reduced.h"
+
+#include <vector>
+#include <string>
+#include <span>
+#include <stack>
+#include <memory>
+#include <utility>
+#include <optional>
+#include <algorithm>
+
+#include "lts/lts.h"
+#include "pcs/topology/core.h"
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/state_codec.h"
+#include "pcs/topology/transfer_index.h"
+#include "pcs/topology/resource_automaton.h"
+
+namespace pcs {
+
+	ReducedTopology::ReducedTopology(const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss)
+		: ReducedTopology(CompileResources(ltss)) {}
+
+	ReducedTopology::ReducedTopology(std::shared_ptr<const std::vector<ResourceAutomaton>> automata)
+		: automata_(std::move(automata)), codec_(automata_), transfer_index_(*automata_) {
+		PackedState initial_packed(codec_.NumOfWords());
+		topology_.set_initial_state(codec_.Names(initial_packed));
+		Combine(initial_packed);
+	}
+
+	const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& ReducedTopology::lts() const {
+		return topology_;
+	}
+
+	ReducedTopology::operator const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& () const {
+		return topology_;
+	}
+
+	const std::vector<std::string>& ReducedTopology::initial_state() const {
+		return topology_.initial_state();
+	}
+
+	const nightly::State<std::vector<std::string>, std::pair<size_t, ParameterizedOp>>& ReducedTopology::at(const std::vector<std::string>& key) {
+		return topology_.states().at(key);
+	}
+
+	/*
+	 * @brief Iterative DFS that only follows the transitions the solvers can realise. Resources without a nop at the
+	 * current state must take part in the transition: with more than two of them nothing is enabled, with two only a
+	 * transfer between exactly those two, with one only transitions it takes part in. A transfer is kept when some
+	 * resource offering its inverse satisfies this with it and moves the lowest such resource, so with a busy resource
+	 * both halves of a synchronising pair pick each other and the solvers find the in and the out transition of a
+	 * transfer together, leading to the same state. Without a busy resource the partner is the one MatchingTransfer picks.
+	 */
+	void ReducedTopology::Combine(const PackedState& initial_key) {
+		std::stack<PackedState> stack;
+		stack.push(initial_key);
+		std::vector<std::string> states_vec;
+		std::vector<size_t> busy;
+
+		while (!stack.empty()) {
+			PackedState key = stack.top();
+			stack.pop();
+
+			if (visited_.Insert(key) == false) {
+				continue;
+			}
+
+			busy.clear();
+			for (size_t i = 0; i < automata_->size() && busy.size() <= 2; ++i) {
+				if (!(*automata_)[i].HasNop(codec_.Get(key, i))) {
+					busy.emplace_back(i);
+				}
+			}
+			if (busy.size() > 2) {
+				continue;
+			}
+			auto involves = [&busy](size_t a, size_t b) {
+				return std::all_of(busy.begin(), busy.end(), [a, b](size_t r) { return r == a || r == b; });
+			};
+			// The lowest resource offering the inverse transfer that may take part with i, with its local target
+			auto partner = [&](size_t i, const ParameterizedOp& transfer) -> std::optional<std::pair<size_t, uint32_t>> {
+				TransferType inverse = (transfer.transfer_type() == TransferType::in) ? TransferType::out : TransferType::in;
+				for (size_t r : transfer_index_.Resources(inverse, transfer.transfer_n())) {
+					if (r == i || !involves(i, r)) {
+						continue;
+					}
+					std::optional<uint32_t> target = transfer_index_.Target(r, codec_.Get(key, r), inverse, transfer.transfer_n());
+					if (target.has_value()) {
+						return std::make_pair(r, *target);
+					}
+				}
+				return {};
+			};
+
+			codec_.Decode(key, states_vec);
+			for (size_t i = 0; i < automata_->size(); ++i) {
+				if (busy.size() == 2 && busy[0] != i && busy[1] != i) {
+					continue;
+				}
+				const ResourceAutomaton& automaton = (*automata_)[i];
+				uint32_t local_state = codec_.Get(key, i);
+				std::span<const uint32_t> targets = automaton.targets(local_state);
+				std::span<const ParameterizedOp> labels = automaton.labels(local_state);
+				for (size_t t = 0; t < targets.size(); ++t) {
+					PackedState next_key = key;
+					if (labels[t].IsTransfer()) {
+						std::optional<std::pair<size_t, uint32_t>> synchronised = partner(i, labels[t]);
+						if (!synchronised.has_value()) {
+							continue;
+						}
+						codec_.Set(next_key, i, targets[t]);
+						codec_.Set(next_key, synchronised->first, synchronised->second);
+					} else {
+						if (!involves(i, i)) {
+							continue;
+						}
+						codec_.Set(next_key, i, targets[t]);
+					}
+					topology_.AddTransition(states_vec, std::make_pair(i, labels[t]), codec_.Names(next_key));
+					stack.push(std::move(next_key));
+				}
+			}
+		}
+	}
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <unordered_set>
+
+#include <boost/container_hash/hash.hpp>
+
+#include "lts/lts.h"
+#include "pcs/topology/topology.h"
+#include "pcs/topology/core.h"
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/packed_state_set.h"
+#include "pcs/topology/state_codec.h"
+#include "pcs/topology/transfer_index.h"
+#include "pcs/topology/resource_automaton.h"
+
+namespace pcs {
+
+	/**
+	 * @brief Topology restricted to the transitions a controller can realise.
+	 *
+	 * The solvers only take an observable transition when every other resource can idle (has a nop) and a transfer
+	 * when every resource other than the two synchronising ones can idle. Transitions violating this are never part
+	 * of a controller, so they are not generated, and neither are the states only reachable through them.
+	 * Transitions of each kept state are in the same order as in CompleteTopology.
+	 *
+	 * This is a realisability filter, not a partial-order reduction: every interleaving of independent transitions
+	 * the solvers could take is still generated. Ample sets do not fit the solvers: whether a resource can nop gates
+	 * every observable transition of the others, so transitions of different resources are rarely independent, and
+	 * the controllers the solvers return are built from the interleavings the topology offers.
+	 */
+	class ReducedTopology : public ITopology {
+	private:
+		nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>> topology_;
+
+		std::shared_ptr<const std::vector<ResourceAutomaton>> automata_;
+		StateCodec codec_;
+		TransferIndex transfer_index_;
+		PackedStateSet visited_;
+	public:
+		ReducedTopology(const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss);
+		ReducedTopology(std::shared_ptr<const std::vector<ResourceAutomaton>> automata);
+		const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& lts() const override;
+		operator const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& () const override;
+		const std::vector<std::string>& initial_state() const override;
+		const nightly::State<std::vector<std::string>, std::pair<size_t, ParameterizedOp>>& at(const std::vector<std::string>& key) override;
+	private:
+		void Combine(const PackedState& initial_key);
+	};
+
+}
@@ -0,0 +1,250 @@
+#include "pcs/topology/resource_automaton.h"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <utility>
+#include <unordered_set>
+#include <unordered_map>
+#include <algorithm>
+
+#include <boost/container_hash/hash.hpp>
+
+#include "lts/lts.h"
+
+namespace pcs {
+
+	ResourceAutomaton::ResourceAutomaton(const nightly::LTS<std::string, ParameterizedOp>& lts) {
+		Compile(lts, nullptr, false);
+	}
+
+	/*
+	 * @brief Only keeps the observable transitions whose operation id is in operations, nops and transfers are always kept.
+	 */
+	ResourceAutomaton::ResourceAutomaton(const nightly::LTS<std::string, ParameterizedOp>& lts, const std::unordered_set<uint32_t>& operations) {
+		Compile(lts, &operations, false);
+	}
+
+	/*
+	 * @brief A resource held in its initial state: same states as the LTS but no transitions. HasNop still reflects
+	 * the LTS, the resource can idle while the others act.
+	 */
+	ResourceAutomaton ResourceAutomaton::Idle(const nightly::LTS<std::string, ParameterizedOp>& lts) {
+		ResourceAutomaton automaton;
+		automaton.Compile(lts, nullptr, true);
+		return automaton;
+	}
+
+	/*
+	 * @brief Quotient by strong bisimulation, computed by iterated signature refinement.
+	 *
+	 * Labels are compared by their interned id, so transfers and nops are as observable as any operation, and states
+	 * that differ in HasNop are never merged. Each block is named after its lowest original state, so the initial state
+	 * stays id 0 under its own name, and every original state name maps to the id of its block.
+	 */
+	ResourceAutomaton ResourceAutomaton::Minimise() const {
+		const uint32_t num_states = static_cast<uint32_t>(names_.size());
+		std::vector<uint32_t> block(num_states);
+		uint32_t num_blocks = 0;
+		for (uint32_t s = 0; s < num_states; ++s) {
+			block[s] = has_nop_[s];
+		}
+		std::vector<uint64_t> signature;
+		while (true) {
+			std::unordered_map<std::vector<uint64_t>, uint32_t, boost::hash<std::vector<uint64_t>>> blocks;
+			std::vector<uint32_t> refined(num_states);
+			for (uint32_t s = 0; s < num_states; ++s) {
+				signature.assign(1, block[s]);
+				for (uint32_t t = offsets_[s]; t < offsets_[s + 1]; ++t) {
+					signature.emplace_back((static_cast<uint64_t>(labels_[t].id()) << 32) | block[targets_[t]]);
+				}
+				std::sort(signature.begin() + 1, signature.end());
+				signature.erase(std::unique(signature.begin() + 1, signature.end()), signature.end());
+				refined[s] = blocks.try_emplace(signature, static_cast<uint32_t>(blocks.size())).first->second;
+			}
+			block = std::move(refined);
+			if (blocks.size() == num_blocks) {
+				break;
+			}
+			num_blocks = static_cast<uint32_t>(blocks.size());
+		}
+
+		ResourceAutomaton quotient;
+		std::vector<uint32_t> representative(num_blocks, num_states);
+		for (uint32_t s = 0; s < num_states; ++s) {
+			if (representative[block[s]] == num_states) {
+				representative[block[s]] = s;
+				quotient.names_.emplace_back(names_[s]);
+				quotient.has_nop_.emplace_back(has_nop_[s]);
+			}
+		}
+		for (const auto& [name, id] : ids_) {
+			quotient.ids_.emplace(name, block[id]);
+		}
+		quotient.offsets_.emplace_back(0);
+		for (uint32_t b = 0; b < num_blocks; ++b) {
+			uint32_t s = representative[b];
+			size_t first = quotient.targets_.size();
+			for (uint32_t t = offsets_[s]; t < offsets_[s + 1]; ++t) {
+				bool duplicate = false;
+				for (size_t q = first; q < quotient.targets_.size(); ++q) {
+					if (quotient.targets_[q] == block[targets_[t]] && quotient.labels_[q] == labels_[t]) {
+						duplicate = true;
+						break;
+					}
+				}
+				if (!duplicate) {
+					quotient.targets_.emplace_back(block[targets_[t]]);
+					quotient.labels_.emplace_back(labels_[t]);
+				}
+			}
+			quotient.offsets_.emplace_back(static_cast<uint32_t>(quotient.targets_.size()));
+		}
+		return quotient;
+	}
+
+	/*
+	 * @brief States are interned in the order initial state, then every state and its successors as they are iterated,
+	 * so the ids are stable for a given LTS and do not depend on the filter.
+	 */
+	void ResourceAutomaton::Compile(const nightly::LTS<std::string, ParameterizedOp>& lts, const std::unordered_set<uint32_t>* operations, bool idle) {
+		Intern(lts.initial_state());
+		for (const auto& [key, state] : lts.states()) {
+			Intern(key);
+			for (const auto& transition : state.transitions_) {
+				Intern(transition.to());
+			}
+		}
+
+		std::vector<std::vector<std::pair<uint32_t, const ParameterizedOp*>>> outgoing(names_.size());
+		has_nop_.assign(names_.size(), 0);
+		size_t num_transitions = 0;
+		for (const auto& [key, state] : lts.states()) {
+			uint32_t id = ids_.at(key);
+			auto& edges = outgoing[id];
+			for (const auto& transition : state.transitions_) {
+				const ParameterizedOp& label = transition.label();
+				if (label.IsNop()) {
+					has_nop_[id] = 1;
+				}
+				if (idle || (operations != nullptr && label.IsObservable() && !operations->contains(label.operation_id()))) {
+					continue;
+				}
+				edges.emplace_back(ids_.at(transition.to()), &label);
+			}
+			num_transitions += edges.size();
+		}
+
+		offsets_.reserve(names_.size() + 1);
+		targets_.reserve(num_transitions);
+		labels_.reserve(num_transitions);
+		offsets_.emplace_back(0);
+		for (const auto& edges : outgoing) {
+			for (const auto& [to, label] : edges) {
+				targets_.emplace_back(to);
+				labels_.emplace_back(*label);
+			}
+			offsets_.emplace_back(static_cast<uint32_t>(targets_.size()));
+		}
+	}
+
+	uint32_t ResourceAutomaton::Intern(const std::string& name) {
+		auto [it, inserted] = ids_.try_emplace(name, static_cast<uint32_t>(names_.size()));
+		if (inserted) {
+			names_.emplace_back(name);
+		}
+		return it->second;
+	}
+
+	size_t ResourceAutomaton::NumOfStates() const {
+		return names_.size();
+	}
+
+	size_t ResourceAutomaton::NumOfTransitions() const {
+		return targets_.size();
+	}
+
+	/*
+	 * @exception Throws std::out_of_range if the resource has no state with the given name
+	 */
+	uint32_t ResourceAutomaton::Id(const std::string& name) const {
+		return ids_.at(name);
+	}
+
+	const std::string& ResourceAutomaton::Name(uint32_t id) const {
+		return names_[id];
+	}
+
+	/*
+	 * @brief Compiles every resource once, the result is shared between the topologies built from it.
+	 */
+	std::shared_ptr<const std::vector<ResourceAutomaton>> CompileResources(const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss) {
+		auto automata = std::make_shared<std::vector<ResourceAutomaton>>();
+		automata->reserve(ltss.size());
+		for (const auto& lts : ltss) {
+			automata->emplace_back(lts);
+		}
+		return automata;
+	}
+
+	/*
+	 * @brief Compiles every resource keeping only the observable transitions whose operation id is in operations.
+	 */
+	std::shared_ptr<const std::vector<ResourceAutomaton>> CompileResources(const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss,
+		                                                                   const std::unordered_set<uint32_t>& operations) {
+		auto automata = std::make_shared<std::vector<ResourceAutomaton>>();
+		automata->reserve(ltss.size());
+		for (const auto& lts : ltss) {
+			automata->emplace_back(lts, operations);
+		}
+		return automata;
+	}
+
+	/*
+	 * @brief Bisimulation quotient of every resource, see ResourceAutomaton::Minimise
+	 */
+	std::shared_ptr<const std::vector<ResourceAutomaton>> MinimiseResources(const std::vector<ResourceAutomaton>& automata) {
+		auto minimised = std::make_shared<std::vector<ResourceAutomaton>>();
+		minimised->reserve(automata.size());
+		for (const auto& automaton : automata) {
+			minimised->emplace_back(automaton.Minimise());
+		}
+		return minimised;
+	}
+
+	/*
+	 * @brief Compiles every resource, the ones that are not in subset are held in their initial state (see Idle).
+	 */
+	std::shared_ptr<const std::vector<ResourceAutomaton>> CompileResources(const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss,
+		                                                                   const std::vector<size_t>& subset) {
+		auto automata = std::make_shared<std::vector<ResourceAutomaton>>();
+		automata->reserve(ltss.size());
+		for (size_t i = 0; i < ltss.size(); ++i) {
+			if (std::find(subset.begin(), subset.end(), i) != subset.end()) {
+				automata->emplace_back(ltss[i]);
+			} else {
+				automata->emplace_back(ResourceAutomaton::Idle(ltss[i]));
+			}
+		}
+		return automata;
+	}
+
+	/*
+	 * @brief Compiles the resources in subset keeping only the observable transitions whose operation id is in operations,
+	 * the other resources are held in their initial state
+	 */
+	std::shared_ptr<const std::vector<ResourceAutomaton>> CompileResources(const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss,
+		                                                                   const std::unordered_set<uint32_t>& operations, const std::vector<size_t>& subset) {
+		auto automata = std::make_shared<std::vector<ResourceAutomaton>>();
+		automata->reserve(ltss.size());
+		for (size_t i = 0; i < ltss.size(); ++i) {
+			if (std::find(subset.begin(), subset.end(), i) != subset.end()) {
+				automata->emplace_back(ltss[i], operations);
+			} else {
+				automata->emplace_back(ResourceAutomaton::Idle(ltss[i]));
+			}
+		}
+		return automata;
+	}
+
+}
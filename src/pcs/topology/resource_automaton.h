@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <span>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+
+#include "lts/lts.h"
+#include "pcs/operation/parameterized_op.h"
+
+namespace pcs {
+
+	/**
+	 * @brief Read-only, compiled form of a resource used on the product construction hot path.
+	 *
+	 * Local states are dense ids (the initial state is always 0) and the outgoing transitions of every state are stored
+	 * contiguously (CSR): the transitions of state s are [offsets[s], offsets[s + 1]) in the targets and labels arrays,
+	 * in the same order as in the source LTS.
+	 */
+	class ResourceAutomaton {
+	private:
+		std::vector<std::string> names_;
+		std::unordered_map<std::string, uint32_t> ids_;
+		std::vector<uint32_t> offsets_;
+		std::vector<uint32_t> targets_;
+		std::vector<ParameterizedOp> labels_;
+		std::vector<uint8_t> has_nop_;
+	public:
+		ResourceAutomaton() = default;
+		ResourceAutomaton(const nightly::LTS<std::string, ParameterizedOp>& lts);
+		ResourceAutomaton(const nightly::LTS<std::string, ParameterizedOp>& lts, const std::unordered_set<uint32_t>& operations);
+		static ResourceAutomaton Idle(const nightly::LTS<std::string, ParameterizedOp>& lts);
+		ResourceAutomaton Minimise() const;
+
+		size_t NumOfStates() const;
+		size_t NumOfTransitions() const;
+
+		uint32_t Id(const std::string& name) const;
+		const std::string& Name(uint32_t id) const;
+
+		std::span<const uint32_t> targets(uint32_t state) const {
+			return { targets_.data() + offsets_[state], targets_.data() + offsets_[state + 1] };
+		}
+
+		std::span<const ParameterizedOp> labels(uint32_t state) const {
+			return { labels_.data() + offsets_[state], labels_.data() + offsets_[state + 1] };
+		}
+
+		/*
+		 * @brief Whether the state has an outgoing nop transition, i.e. the resource can idle while another one acts
+		 */
+		bool HasNop(uint32_t state) const {
+			return has_nop_[state] != 0;
+		}
+	private:
+		void Compile(const nightly::LTS<std::string, ParameterizedOp>& lts, const std::unordered_set<uint32_t>* operations, bool idle);
+		uint32_t Intern(const std::string& name);
+	};
+
+	std::shared_ptr<const std::vector<ResourceAutomaton>> CompileResources(const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss);
+	std::shared_ptr<const std::vector<ResourceAutomaton>> CompileResources(const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss,
+		                                                                   const std::unordered_set<uint32_t>& operations);
+	std::shared_ptr<const std::vector<ResourceAutomaton>> CompileResources(const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss,
+		                                                                   const std::vector<size_t>& subset);
+	std::shared_ptr<const std::vector<ResourceAutomaton>> CompileResources(const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss,
+		                                                                   const std::unordered_set<uint32_t>& operations, const std::vector<size_t>& subset);
+	std::shared_ptr<const std::vector<ResourceAutomaton>> MinimiseResources(const std::vector<ResourceAutomaton>& automata);
+
+}
@@ -0,0 +1,384 @@
+#include "pcs/topology/snapshot.h"
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+#include "lts/lts.h"
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/state_codec.h"
+#include "pcs/topology/resource_automaton.h"
+#include "pcs/common/directory.h"
+
+namespace pcs {
+
+	static_assert(sizeof(SnapshotHeader) == 64);
+	static_assert(sizeof(FrozenTopology::Edge) == 12);
+
+	namespace {
+
+		constexpr uint64_t kFnvOffset = 0xCBF29CE484222325ull;
+		constexpr uint64_t kFnvPrime = 0x100000001B3ull;
+
+		void HashBytes(uint64_t& h, const void* data, size_t size) {
+			const unsigned char* bytes = static_cast<const unsigned char*>(data);
+			for (size_t i = 0; i < size; ++i) {
+				h = (h ^ bytes[i]) * kFnvPrime;
+			}
+		}
+
+		void HashValue(uint64_t& h, uint64_t value) {
+			HashBytes(h, &value, sizeof(value));
+		}
+
+		void HashString(uint64_t& h, const std::string& str) {
+			HashValue(h, str.size());
+			HashBytes(h, str.data(), str.size());
+		}
+
+		void HashLabel(uint64_t& h, const ParameterizedOp& label) {
+			HashString(h, label.operation());
+			std::vector<std::pair<std::string, std::string>> sorted(label.parameters().map().begin(), label.parameters().map().end());
+			std::sort(sorted.begin(), sorted.end());
+			HashValue(h, sorted.size());
+			for (const auto& [name, value] : sorted) {
+				HashString(h, name);
+				HashString(h, value);
+			}
+		}
+
+		size_t Padding(size_t size) {
+			return (8 - (size % 8)) % 8;
+		}
+
+		void WritePadding(std::ofstream& os, size_t size) {
+			static constexpr char zeros[8] = {};
+			os.write(zeros, static_cast<std::streamsize>(Padding(size)));
+		}
+
+		void WriteString(std::string& out, const std::string& str) {
+			uint32_t size = static_cast<uint32_t>(str.size());
+			out.append(reinterpret_cast<const char*>(&size), sizeof(size));
+			out.append(str);
+		}
+
+		std::string ReadString(const std::byte*& it, const std::byte* end) {
+			uint32_t size;
+			if (static_cast<size_t>(end - it) < sizeof(size)) {
+				throw std::runtime_error("Truncated topology snapshot");
+			}
+			std::memcpy(&size, it, sizeof(size));
+			it += sizeof(size);
+			if (static_cast<size_t>(end - it) < size) {
+				throw std::runtime_error("Truncated topology snapshot");
+			}
+			std::string str(reinterpret_cast<const char*>(it), size);
+			it += size;
+			return str;
+		}
+
+	}
+
+	/*
+	 * @brief 64-bit FNV-1a hash over the state names, transitions and labels of the compiled resources.
+	 * Unlike label ids it is stable across processes, so it identifies the resources a snapshot was computed from.
+	 */
+	uint64_t ResourcesHash(const std::vector<ResourceAutomaton>& automata) {
+		uint64_t h = kFnvOffset;
+		HashValue(h, automata.size());
+		for (const auto& automaton : automata) {
+			HashValue(h, automaton.NumOfStates());
+			for (uint32_t state = 0; state < automaton.NumOfStates(); ++state) {
+				HashString(h, automaton.Name(state));
+				HashValue(h, automaton.HasNop(state));
+				std::span<const uint32_t> targets = automaton.targets(state);
+				std::span<const ParameterizedOp> labels = automaton.labels(state);
+				HashValue(h, targets.size());
+				for (size_t t = 0; t < targets.size(); ++t) {
+					HashValue(h, targets[t]);
+					HashLabel(h, labels[t]);
+				}
+			}
+		}
+		return h;
+	}
+
+	/*
+	 * @brief Writes the frozen topology to a snapshot that MappedTopology can map back in.
+	 * @exception Propagates std::ofstream::failure
+	 */
+	void SaveSnapshot(const FrozenTopology& topology, const std::filesystem::path& path) {
+		const StateCodec& codec = topology.codec();
+		size_t num_states = topology.NumOfStates();
+		size_t num_words = codec.NumOfWords();
+
+		std::vector<uint64_t> keys;
+		keys.reserve(num_states * num_words);
+		for (uint32_t id = 0; id < num_states; ++id) {
+			PackedState key = topology.packed(id);
+			for (size_t w = 0; w < num_words; ++w) {
+				keys.emplace_back(key.word(w));
+			}
+		}
+
+		std::vector<uint32_t> sorted(num_states);
+		for (uint32_t id = 0; id < num_states; ++id) {
+			sorted[id] = id;
+		}
+		std::sort(sorted.begin(), sorted.end(), [&keys, num_words](uint32_t lhs, uint32_t rhs) {
+			return std::lexicographical_compare(keys.begin() + lhs * num_words, keys.begin() + (lhs + 1) * num_words,
+				                                keys.begin() + rhs * num_words, keys.begin() + (rhs + 1) * num_words);
+		});
+
+		std::vector<uint64_t> offsets;
+		std::vector<FrozenTopology::Edge> edges;
+		offsets.reserve(num_states + 1);
+		edges.reserve(topology.NumOfTransitions());
+		offsets.emplace_back(0);
+		for (uint32_t id = 0; id < num_states; ++id) {
+			edges.insert(edges.end(), topology.edges(id).begin(), topology.edges(id).end());
+			offsets.emplace_back(edges.size());
+		}
+
+		std::vector<ParameterizedOp> frozen_labels;
+		frozen_labels.reserve(topology.NumOfLabels());
+		for (uint32_t id = 0; id < topology.NumOfLabels(); ++id) {
+			frozen_labels.emplace_back(topology.label(id));
+		}
+		std::string labels = EncodeSnapshotLabels(frozen_labels);
+
+		SnapshotHeader header{};
+		std::memcpy(header.magic, SnapshotHeader::kMagic, sizeof(header.magic));
+		header.version = SnapshotHeader::kVersion;
+		header.byte_order = SnapshotHeader::kByteOrder;
+		header.num_words = static_cast<uint32_t>(num_words);
+		header.resources_hash = ResourcesHash(*topology.automata());
+		header.num_states = num_states;
+		header.num_edges = edges.size();
+		header.num_labels = topology.NumOfLabels();
+		header.labels_size = labels.size();
+
+		CreateDirectoryForPath(path);
+		std::ofstream os(path, std::ios::binary | std::ios::trunc);
+		os.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+		os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		os.write(reinterpret_cast<const char*>(keys.data()), static_cast<std::streamsize>(keys.size() * sizeof(uint64_t)));
+		os.write(reinterpret_cast<const char*>(sorted.data()), static_cast<std::streamsize>(sorted.size() * sizeof(uint32_t)));
+		WritePadding(os, sorted.size() * sizeof(uint32_t));
+		os.write(reinterpret_cast<const char*>(offsets.data()), static_cast<std::streamsize>(offsets.size() * sizeof(uint64_t)));
+		os.write(reinterpret_cast<const char*>(edges.data()), static_cast<std::streamsize>(edges.size() * sizeof(FrozenTopology::Edge)));
+		WritePadding(os, edges.size() * sizeof(FrozenTopology::Edge));
+		os.write(labels.data(), static_cast<std::streamsize>(labels.size()));
+	}
+
+	/*
+	 * @brief Encodes the label section of a snapshot, parameters are sorted so that equal labels encode equally
+	 */
+	std::string EncodeSnapshotLabels(std::span<const ParameterizedOp> labels) {
+		std::string encoded;
+		for (const auto& label : labels) {
+			WriteString(encoded, label.operation());
+			std::vector<std::pair<std::string, std::string>> parameters(label.parameters().map().begin(), label.parameters().map().end());
+			std::sort(parameters.begin(), parameters.end());
+			uint32_t num_parameters = static_cast<uint32_t>(parameters.size());
+			encoded.append(reinterpret_cast<const char*>(&num_parameters), sizeof(num_parameters));
+			for (const auto& [name, value] : parameters) {
+				WriteString(encoded, name);
+				WriteString(encoded, value);
+			}
+		}
+		return encoded;
+	}
+
+	/*
+	 * @exception Throws std::runtime_error if the file is not a snapshot of this version and byte order, is truncated,
+	 * was computed from different resources or is corrupt, see Validate
+	 */
+	MappedTopology::MappedTopology(const std::filesystem::path& path, std::shared_ptr<const std::vector<ResourceAutomaton>> automata)
+		: automata_(std::move(automata)), codec_(automata_), file_(path) {
+		if (file_.size() < sizeof(SnapshotHeader)) {
+			throw std::runtime_error("Truncated topology snapshot");
+		}
+		header_ = reinterpret_cast<const SnapshotHeader*>(file_.data());
+		if (std::memcmp(header_->magic, SnapshotHeader::kMagic, sizeof(header_->magic)) != 0) {
+			throw std::runtime_error(path.string() + " is not a topology snapshot");
+		}
+		if (header_->version != SnapshotHeader::kVersion || header_->byte_order != SnapshotHeader::kByteOrder) {
+			throw std::runtime_error("Unsupported topology snapshot version or byte order");
+		}
+		if (header_->resources_hash != ResourcesHash(*automata_) || header_->num_words != codec_.NumOfWords()) {
+			throw std::runtime_error("Topology snapshot was computed from different resources");
+		}
+
+		// Bounds the counts before they are multiplied, so that a corrupt header cannot wrap the expected size around
+		if (header_->num_states > file_.size() || header_->num_edges > file_.size()) {
+			throw std::runtime_error("Truncated topology snapshot");
+		}
+		size_t num_states = header_->num_states;
+		size_t keys_size = num_states * header_->num_words * sizeof(uint64_t);
+		size_t sorted_size = num_states * sizeof(uint32_t);
+		size_t offsets_size = (num_states + 1) * sizeof(uint64_t);
+		size_t edges_size = header_->num_edges * sizeof(FrozenTopology::Edge);
+		size_t expected = sizeof(SnapshotHeader) + keys_size + sorted_size + Padding(sorted_size) + offsets_size
+			            + edges_size + Padding(edges_size) + header_->labels_size;
+		if (num_states == 0 || file_.size() != expected) {
+			throw std::runtime_error("Truncated topology snapshot");
+		}
+
+		const std::byte* it = file_.data() + sizeof(SnapshotHeader);
+		keys_ = { reinterpret_cast<const uint64_t*>(it), num_states * header_->num_words };
+		it += keys_size;
+		sorted_ = { reinterpret_cast<const uint32_t*>(it), num_states };
+		it += sorted_size + Padding(sorted_size);
+		offsets_ = { reinterpret_cast<const uint64_t*>(it), num_states + 1 };
+		it += offsets_size;
+		edges_ = { reinterpret_cast<const FrozenTopology::Edge*>(it), header_->num_edges };
+		it += edges_size + Padding(edges_size);
+
+		const std::byte* end = file_.data() + file_.size();
+		labels_.reserve(header_->num_labels);
+		for (uint64_t i = 0; i < header_->num_labels; ++i) {
+			std::string operation = ReadString(it, end);
+			uint32_t num_parameters;
+			if (static_cast<size_t>(end - it) < sizeof(num_parameters)) {
+				throw std::runtime_error("Truncated topology snapshot");
+			}
+			std::memcpy(&num_parameters, it, sizeof(num_parameters));
+			it += sizeof(num_parameters);
+			Parameters parameters;
+			for (uint32_t p = 0; p < num_parameters; ++p) {
+				std::string name = ReadString(it, end);
+				parameters.map().emplace(std::move(name), ReadString(it, end));
+			}
+			labels_.emplace_back(std::move(operation), std::move(parameters));
+		}
+		Validate();
+
+		materialised_.set_initial_state(Key(0));
+	}
+
+	/*
+	 * @brief Renders the full LTS on the first call, transitions of every state keep the order they were saved in.
+	 */
+	const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& MappedTopology::lts() const {
+		if (!lts_) {
+			lts_ = std::make_unique<nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>>();
+			lts_->set_initial_state(Key(0));
+			for (uint32_t id = 0; id < header_->num_states; ++id) {
+				std::vector<std::string> from = Key(id);
+				for (const auto& edge : edges(id)) {
+					lts_->AddTransition(from, std::make_pair(static_cast<size_t>(edge.resource), labels_[edge.label]), Key(edge.to));
+				}
+			}
+		}
+		return *lts_;
+	}
+
+	MappedTopology::operator const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& () const {
+		return lts();
+	}
+
+	const std::vector<std::string>& MappedTopology::initial_state() const {
+		return materialised_.initial_state();
+	}
+
+	/*
+	 * @brief Renders the transitions of a single state the first time it is asked for.
+	 * @exception Throws std::out_of_range if key is not a state of the topology
+	 */
+	const nightly::State<std::vector<std::string>, std::pair<size_t, ParameterizedOp>>& MappedTopology::at(const std::vector<std::string>& key) {
+		uint32_t id = Id(key);
+		if (is_materialised_.emplace(id).second) {
+			for (const auto& edge : edges(id)) {
+				materialised_.AddTransition(key, std::make_pair(static_cast<size_t>(edge.resource), labels_[edge.label]), Key(edge.to));
+			}
+		}
+		return materialised_.states().at(key);
+	}
+
+	size_t MappedTopology::NumOfStates() const {
+		return header_->num_states;
+	}
+
+	size_t MappedTopology::NumOfTransitions() const {
+		return header_->num_edges;
+	}
+
+	uint64_t MappedTopology::resources_hash() const {
+		return header_->resources_hash;
+	}
+
+	/*
+	 * @brief Binary search over the states sorted by key.
+	 * @exception Throws std::out_of_range if key is not a state of the topology
+	 */
+	uint32_t MappedTopology::Id(const std::vector<std::string>& key) const {
+		PackedState packed = codec_.Encode(key);
+		size_t num_words = header_->num_words;
+		auto compare = [this, num_words](uint32_t id, const PackedState& state) {
+			for (size_t w = 0; w < num_words; ++w) {
+				uint64_t word = keys_[id * num_words + w];
+				if (word != state.word(w)) {
+					return word < state.word(w);
+				}
+			}
+			return false;
+		};
+		auto it = std::lower_bound(sorted_.begin(), sorted_.end(), packed, compare);
+		if (it == sorted_.end() || !(Packed(*it) == packed)) {
+			throw std::out_of_range("State is not part of the topology");
+		}
+		return *it;
+	}
+
+	std::vector<std::string> MappedTopology::Key(uint32_t id) const {
+		return codec_.Names(Packed(id));
+	}
+
+	/*
+	 * @brief One pass over the mapped sections checking every index the accessors follow: offsets are ascending
+	 * from 0 to num_edges, edges point to existing states, labels and resources, sorted ids are states and every
+	 * key holds a valid local state of each resource. Later reads then never leave the mapping.
+	 * @exception Throws std::runtime_error on the first violation
+	 */
+	void MappedTopology::Validate() const {
+		const size_t num_states = sorted_.size();
+		if (offsets_.front() != 0 || offsets_.back() != edges_.size()) {
+			throw std::runtime_error("Corrupt topology snapshot: edge offsets do not span the edges");
+		}
+		for (size_t id = 0; id < num_states; ++id) {
+			if (offsets_[id] > offsets_[id + 1]) {
+				throw std::runtime_error("Corrupt topology snapshot: edge offsets are not ascending");
+			}
+			if (sorted_[id] >= num_states) {
+				throw std::runtime_error("Corrupt topology snapshot: sorted state id out of range");
+			}
+			PackedState key = Packed(static_cast<uint32_t>(id));
+			for (size_t i = 0; i < automata_->size(); ++i) {
+				if (codec_.Get(key, i) >= (*automata_)[i].NumOfStates()) {
+					throw std::runtime_error("Corrupt topology snapshot: state key out of range");
+				}
+			}
+		}
+		for (const auto& edge : edges_) {
+			if (edge.to >= num_states || edge.label >= labels_.size() || edge.resource >= automata_->size()) {
+				throw std::runtime_error("Corrupt topology snapshot: edge out of range");
+			}
+		}
+	}
+
+	PackedState MappedTopology::Packed(uint32_t id) const {
+		size_t num_words = header_->num_words;
+		PackedState state(num_words);
+		for (size_t w = 0; w < num_words; ++w) {
+			state.set_word(w, keys_[id * num_words + w]);
+		}
+		return state;
+	}
+
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <span>
+#include <memory>
+#include <filesystem>
+#include <unordered_set>
+#include <cstdint>
+
+#include <boost/container_hash/hash.hpp>
+
+#include "lts/lts.h"
+#include "pcs/topology/topology.h"
+#include "pcs/topology/frozen.h"
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/state_codec.h"
+#include "pcs/topology/resource_automaton.h"
+#include "pcs/common/mapped_file.h"
+
+namespace pcs {
+
+	/**
+	 * @brief: Fixed-size header at the start of a topology snapshot.
+	 *
+	 * It is followed by the sections, each starting on an 8 byte boundary:
+	 * keys (num_states * num_words uint64), state ids sorted by key (num_states uint32),
+	 * offsets (num_states + 1 uint64), edges (num_edges FrozenTopology::Edge) and the labels.
+	 * A label is its operation followed by its parameters, every string stored as a uint32 length and its bytes.
+	 * Everything is in the byte order of the machine that wrote the snapshot.
+	 */
+	struct SnapshotHeader {
+		static constexpr char kMagic[8] = { 'P', 'C', 'S', 'T', 'O', 'P', 'O', '\0' };
+		static constexpr uint32_t kVersion = 1;
+		static constexpr uint32_t kByteOrder = 0x01020304;
+
+		char magic[8];
+		uint32_t version;
+		uint32_t byte_order;
+		uint32_t num_words;
+		uint32_t reserved;
+		uint64_t resources_hash;
+		uint64_t num_states;
+		uint64_t num_edges;
+		uint64_t num_labels;
+		uint64_t labels_size;
+	};
+
+	uint64_t ResourcesHash(const std::vector<ResourceAutomaton>& automata);
+	void SaveSnapshot(const FrozenTopology& topology, const std::filesystem::path& path);
+	std::string EncodeSnapshotLabels(std::span<const ParameterizedOp> labels);
+
+	/**
+	 * @brief Read-only topology backed by a memory-mapped snapshot written by SaveSnapshot.
+	 *
+	 * The states and edges are used in place from the mapping, only the labels are interned when the snapshot is opened.
+	 * The snapshot must have been written for the same compiled resources, which is checked through their content hash.
+	 * at() and lts() render the nightly::LTS view on demand in the same way as FrozenTopology.
+	 */
+	class MappedTopology : public ITopology {
+	private:
+		std::shared_ptr<const std::vector<ResourceAutomaton>> automata_;
+		StateCodec codec_;
+		MappedFile file_;
+		const SnapshotHeader* header_ = nullptr;
+
+		std::span<const uint64_t> keys_;
+		std::span<const uint32_t> sorted_;
+		std::span<const uint64_t> offsets_;
+		std::span<const FrozenTopology::Edge> edges_;
+		std::vector<ParameterizedOp> labels_;
+
+		nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>> materialised_;
+		std::unordered_set<uint32_t> is_materialised_;
+		mutable std::unique_ptr<nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>> lts_;
+	public:
+		MappedTopology(const std::filesystem::path& path, std::shared_ptr<const std::vector<ResourceAutomaton>> automata);
+
+		const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& lts() const override;
+		operator const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& () const override;
+		const std::vector<std::string>& initial_state() const override;
+		const nightly::State<std::vector<std::string>, std::pair<size_t, ParameterizedOp>>& at(const std::vector<std::string>& key) override;
+
+		size_t NumOfStates() const override;
+		size_t NumOfTransitions() const;
+		uint64_t resources_hash() const;
+		uint32_t Id(const std::vector<std::string>& key) const;
+		std::vector<std::string> Key(uint32_t id) const;
+
+		std::span<const FrozenTopology::Edge> edges(uint32_t id) const {
+			return edges_.subspan(offsets_[id], offsets_[id + 1] - offsets_[id]);
+		}
+
+		const ParameterizedOp& label(uint32_t id) const {
+			return labels_[id];
+		}
+	private:
+		void Validate() const;
+		PackedState Packed(uint32_t id) const;
+	};
+
+}
@@ -0,0 +1,132 @@
+#include "pcs/topology/state_codec.h"
+
+#include <vector>
+#include <string>
+#include <span>
+#include <memory>
+#include <utility>
+#include <bit>
+#include <limits>
+#include <cstdint>
+
+#include "lts/lts.h"
+
+namespace pcs {
+
+	StateCodec::StateCodec(const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss)
+		: StateCodec(CompileResources(ltss)) {}
+
+	StateCodec::StateCodec(std::shared_ptr<const std::vector<ResourceAutomaton>> automata)
+		: automata_(std::move(automata)), radices_(automata_->size()) {
+		for (size_t i = 0; i < automata_->size(); ++i) {
+			radices_[i] = (*automata_)[i].NumOfStates();
+		}
+		ComputeLayout();
+	}
+
+	/*
+	 * @brief Uses a single mixed-radix word when the product of the radices fits, otherwise packs bit fields
+	 * that never straddle a word boundary.
+	 */
+	void StateCodec::ComputeLayout() {
+		uint64_t product = 1;
+		bool fits = true;
+		strides_.assign(radices_.size(), 0);
+		for (size_t i = 0; i < radices_.size(); ++i) {
+			strides_[i] = product;
+			if (product > std::numeric_limits<uint64_t>::max() / radices_[i]) {
+				fits = false;
+				break;
+			}
+			product *= radices_[i];
+		}
+		if (fits) {
+			layout_ = Layout::MixedRadix;
+			num_words_ = 1;
+			return;
+		}
+
+		layout_ = Layout::BitFields;
+		strides_.clear();
+		words_.resize(radices_.size());
+		shifts_.resize(radices_.size());
+		masks_.resize(radices_.size());
+		uint32_t word = 0, offset = 0;
+		for (size_t i = 0; i < radices_.size(); ++i) {
+			uint32_t width = static_cast<uint32_t>(std::bit_width(radices_[i] - 1));
+			if (offset + width > 64) {
+				++word;
+				offset = 0;
+			}
+			words_[i] = word;
+			shifts_[i] = offset;
+			masks_[i] = (width == 0) ? 0 : (std::numeric_limits<uint64_t>::max() >> (64 - width));
+			offset += width;
+		}
+		num_words_ = word + 1;
+	}
+
+	size_t StateCodec::NumOfResources() const {
+		return radices_.size();
+	}
+
+	size_t StateCodec::NumOfWords() const {
+		return num_words_;
+	}
+
+	StateCodec::Layout StateCodec::layout() const {
+		return layout_;
+	}
+
+	uint64_t StateCodec::radix(size_t resource) const {
+		return radices_[resource];
+	}
+
+	/*
+	 * @exception Throws std::out_of_range if the resource has no state with the given name
+	 */
+	uint32_t StateCodec::Id(size_t resource, const std::string& name) const {
+		return (*automata_)[resource].Id(name);
+	}
+
+	const std::string& StateCodec::Name(size_t resource, uint32_t id) const {
+		return (*automata_)[resource].Name(id);
+	}
+
+	PackedState StateCodec::Encode(const std::vector<std::string>& names) const {
+		PackedState state(num_words_);
+		for (size_t i = 0; i < names.size(); ++i) {
+			Set(state, i, Id(i, names[i]));
+		}
+		return state;
+	}
+
+	PackedState StateCodec::Encode(std::span<const uint32_t> ids) const {
+		PackedState state(num_words_);
+		for (size_t i = 0; i < ids.size(); ++i) {
+			Set(state, i, ids[i]);
+		}
+		return state;
+	}
+
+	void StateCodec::Decode(const PackedState& state, std::vector<uint32_t>& ids) const {
+		ids.resize(radices_.size());
+		for (size_t i = 0; i < radices_.size(); ++i) {
+			ids[i] = Get(state, i);
+		}
+	}
+
+	void StateCodec::Decode(const PackedState& state, std::vector<std::string>& names) const {
+		names.resize(radices_.size());
+		for (size_t i = 0; i < radices_.size(); ++i) {
+			names[i] = (*automata_)[i].Name(Get(state, i));
+		}
+	}
+
+	std::vector<std::string> StateCodec::Names(const PackedState& state) const {
+		std::vector<std::string> names;
+		Decode(state, names);
+		return names;
+	}
+
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <span>
+#include <memory>
+#include <cstdint>
+
+#include "lts/lts.h"
+#include "pcs/operation/parameterized_op.h"
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/resource_automaton.h"
+
+namespace pcs {
+
+	/**
+	 * @brief Packs topology states, tuples of local state ids of the compiled resources, into PackedStates.
+	 *
+	 * When the product of the per-resource state counts fits in 64 bits a state is a single mixed-radix integer,
+	 * otherwise each resource gets a fixed-width bit field and the fields are spread over as many words as needed.
+	 */
+	class StateCodec {
+	public:
+		enum class Layout { MixedRadix, BitFields };
+	private:
+		std::shared_ptr<const std::vector<ResourceAutomaton>> automata_;
+		std::vector<uint64_t> radices_;
+		Layout layout_ = Layout::MixedRadix;
+		size_t num_words_ = 1;
+
+		// Mixed radix layout
+		std::vector<uint64_t> strides_;
+
+		// Bit field layout
+		std::vector<uint32_t> words_;
+		std::vector<uint32_t> shifts_;
+		std::vector<uint64_t> masks_;
+	public:
+		StateCodec() = default;
+		StateCodec(const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss);
+		StateCodec(std::shared_ptr<const std::vector<ResourceAutomaton>> automata);
+
+		size_t NumOfResources() const;
+		size_t NumOfWords() const;
+		Layout layout() const;
+		uint64_t radix(size_t resource) const;
+
+		uint32_t Id(size_t resource, const std::string& name) const;
+		const std::string& Name(size_t resource, uint32_t id) const;
+
+		PackedState Encode(const std::vector<std::string>& names) const;
+		PackedState Encode(std::span<const uint32_t> ids) const;
+		void Decode(const PackedState& state, std::vector<uint32_t>& ids) const;
+		void Decode(const PackedState& state, std::vector<std::string>& names) const;
+		std::vector<std::string> Names(const PackedState& state) const;
+
+		uint32_t Get(const PackedState& state, size_t resource) const {
+			if (layout_ == Layout::MixedRadix) {
+				return static_cast<uint32_t>((state.word(0) / strides_[resource]) % radices_[resource]);
+			}
+			return static_cast<uint32_t>((state.word(words_[resource]) >> shifts_[resource]) & masks_[resource]);
+		}
+
+		void Set(PackedState& state, size_t resource, uint32_t id) const {
+			if (layout_ == Layout::MixedRadix) {
+				uint64_t current = Get(state, resource);
+				state.set_word(0, state.word(0) - (current * strides_[resource]) + (id * strides_[resource]));
+				return;
+			}
+			uint64_t w = state.word(words_[resource]);
+			w &= ~(masks_[resource] << shifts_[resource]);
+			w |= (static_cast<uint64_t>(id) & masks_[resource]) << shifts_[resource];
+			state.set_word(words_[resource], w);
+		}
+	private:
+		void ComputeLayout();
+	};
+
+}
@@ -0,0 +1,72 @@
+#include "pcs/topology/successors.h"
+
+#include <vector>
+#include <span>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "pcs/topology/core.h"
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/state_codec.h"
+#include "pcs/topology/resource_automaton.h"
+#include "pcs/topology/transfer_index.h"
+
+namespace pcs {
+
+	SuccessorGenerator::SuccessorGenerator(std::shared_ptr<const std::vector<ResourceAutomaton>> automata)
+		: automata_(std::move(automata)), codec_(automata_), transfer_index_(*automata_) {}
+
+	const std::vector<ResourceAutomaton>& SuccessorGenerator::automata() const {
+		return *automata_;
+	}
+
+	const StateCodec& SuccessorGenerator::codec() const {
+		return codec_;
+	}
+
+	/*
+	 * @brief Local state id 0 of every resource
+	 */
+	PackedState SuccessorGenerator::initial_state() const {
+		return PackedState(codec_.NumOfWords());
+	}
+
+	SuccessorGenerator::Iterator::Iterator(const SuccessorGenerator* generator, const PackedState* state)
+		: generator_(generator), state_(state) {
+		Advance();
+	}
+
+	/*
+	 * @brief Moves from (resource_, transition_) to the next transition that can be taken and computes its target,
+	 * transfers without a partner are skipped. Becomes the end iterator after the last transition of the last resource.
+	 */
+	void SuccessorGenerator::Iterator::Advance() {
+		const std::vector<ResourceAutomaton>& automata = *generator_->automata_;
+		const StateCodec& codec = generator_->codec_;
+		for (; resource_ < automata.size(); ++resource_, transition_ = 0) {
+			const ResourceAutomaton& automaton = automata[resource_];
+			uint32_t local_state = codec.Get(*state_, resource_);
+			std::span<const uint32_t> targets = automaton.targets(local_state);
+			std::span<const ParameterizedOp> labels = automaton.labels(local_state);
+			for (; transition_ < targets.size(); ++transition_) {
+				if (labels[transition_].IsTransfer()) {
+					std::optional<PackedState> transfer_state = MatchingTransfer(generator_->transfer_index_, codec, *state_, resource_,
+						                                                         labels[transition_], targets[transition_]);
+					if (!transfer_state.has_value()) {
+						continue;
+					}
+					current_.state = std::move(*transfer_state);
+				} else {
+					current_.state = *state_;
+					codec.Set(current_.state, resource_, targets[transition_]);
+				}
+				current_.resource = resource_;
+				current_.label = &labels[transition_];
+				return;
+			}
+		}
+		generator_ = nullptr;
+	}
+
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <iterator>
+#include <cstdint>
+
+#include "pcs/operation/parameterized_op.h"
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/state_codec.h"
+#include "pcs/topology/resource_automaton.h"
+#include "pcs/topology/transfer_index.h"
+
+namespace pcs {
+
+	/**
+	 * @brief A transition of the topology: the resource that takes it, its label and the packed state it leads to.
+	 * The label points into the compiled resources, which outlive the generator that produced it.
+	 */
+	struct Successor {
+		size_t resource;
+		const ParameterizedOp* label;
+		PackedState state;
+	};
+
+	/**
+	 * @brief Computes the successors of a packed topology state directly from the compiled resources.
+	 *
+	 * Nothing is stored per state: the successors are produced one at a time by iterating over Successors(state), in
+	 * the same order as the transitions of every other topology (by resource, then by local transition), and a
+	 * transfer leads to the state of the partner MatchingTransfer picks. Traversals that only need to walk the product
+	 * can therefore run without a topology, keeping only what they need themselves.
+	 */
+	class SuccessorGenerator {
+	private:
+		std::shared_ptr<const std::vector<ResourceAutomaton>> automata_;
+		StateCodec codec_;
+		TransferIndex transfer_index_;
+	public:
+		class Iterator {
+		private:
+			const SuccessorGenerator* generator_ = nullptr;
+			const PackedState* state_ = nullptr;
+			size_t resource_ = 0;
+			size_t transition_ = 0;
+			Successor current_{};
+		public:
+			using iterator_category = std::input_iterator_tag;
+			using value_type = Successor;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const Successor*;
+			using reference = const Successor&;
+
+			Iterator() = default;
+			Iterator(const SuccessorGenerator* generator, const PackedState* state);
+
+			reference operator*() const {
+				return current_;
+			}
+
+			pointer operator->() const {
+				return &current_;
+			}
+
+			Iterator& operator++() {
+				++transition_;
+				Advance();
+				return *this;
+			}
+
+			void operator++(int) {
+				++*this;
+			}
+
+			bool operator==(std::default_sentinel_t) const {
+				return generator_ == nullptr;
+			}
+		private:
+			void Advance();
+		};
+
+		class Range {
+		private:
+			const SuccessorGenerator* generator_;
+			const PackedState* state_;
+		public:
+			Range(const SuccessorGenerator* generator, const PackedState* state) : generator_(generator), state_(state) {}
+
+			Iterator begin() const {
+				return Iterator(generator_, state_);
+			}
+
+			std::default_sentinel_t end() const {
+				return std::default_sentinel;
+			}
+		};
+
+		SuccessorGenerator(std::shared_ptr<const std::vector<ResourceAutomaton>> automata);
+
+		const std::vector<ResourceAutomaton>& automata() const;
+		const StateCodec& codec() const;
+		PackedState initial_state() const;
+
+		/*
+		 * @brief The successors of state, state must outlive the iteration
+		 */
+		Range Successors(const PackedState& state) const {
+			return Range(this, &state);
+		}
+	};
+
+}
@@ -0,0 +1,240 @@
+#include "pcs/topology/symbolic.h"
+
+#include <vector>
+#include <span>
+#include <string>
+#include <memory>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+
+#include "lts/lts.h"
+#include "pcs/topology/mdd.h"
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/state_codec.h"
+#include "pcs/topology/transfer_index.h"
+#include "pcs/topology/resource_automaton.h"
+
+namespace pcs {
+
+	namespace {
+
+		std::vector<uint32_t> Domains(const std::vector<ResourceAutomaton>& automata) {
+			std::vector<uint32_t> domains;
+			domains.reserve(automata.size());
+			for (const auto& automaton : automata) {
+				domains.emplace_back(static_cast<uint32_t>(automaton.NumOfStates()));
+			}
+			return domains;
+		}
+
+		bool IsEmpty(const Mdd::LevelRelation& relation) {
+			return std::all_of(relation.successors.begin(), relation.successors.end(),
+				[](const std::vector<uint32_t>& successors) { return successors.empty(); });
+		}
+
+	}
+
+	SymbolicTopology::SymbolicTopology(const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss)
+		: SymbolicTopology(CompileResources(ltss)) {}
+
+	SymbolicTopology::SymbolicTopology(std::shared_ptr<const std::vector<ResourceAutomaton>> automata)
+		: automata_(std::move(automata)), codec_(automata_), transfer_index_(*automata_), mdd_(Domains(*automata_)) {
+		topology_.set_initial_state(codec_.Names(PackedState(codec_.NumOfWords())));
+		BuildEvents();
+		Reach();
+	}
+
+	const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& SymbolicTopology::lts() const {
+		return topology_;
+	}
+
+	SymbolicTopology::operator const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& () const {
+		return topology_;
+	}
+
+	const std::vector<std::string>& SymbolicTopology::initial_state() const {
+		return topology_.initial_state();
+	}
+
+	/*
+	 * @exception Throws std::out_of_range if key is not a reachable state
+	 */
+	const nightly::State<std::vector<std::string>, std::pair<size_t, ParameterizedOp>>& SymbolicTopology::at(const std::vector<std::string>& key) {
+		PackedState packed_key = codec_.Encode(key);
+		if (visited_.Contains(packed_key) == false) {
+			if (!Contains(key)) {
+				throw std::out_of_range("State is not reachable");
+			}
+			ExpandState(key, packed_key);
+			visited_.Insert(packed_key);
+		}
+		return topology_.states().at(key);
+	}
+
+	/*
+	 * @brief Number of reachable states, saturated at the size_t maximum, see NumOfReachableStates
+	 */
+	size_t SymbolicTopology::NumOfStates() const {
+		double num_states = NumOfReachableStates();
+		return (num_states >= static_cast<double>(std::numeric_limits<size_t>::max())) ? std::numeric_limits<size_t>::max() : static_cast<size_t>(num_states);
+	}
+
+	/*
+	 * @brief Number of reachable states, as a double since it may exceed 64 bits
+	 */
+	double SymbolicTopology::NumOfReachableStates() const {
+		return mdd_.Count(reachable_);
+	}
+
+	size_t SymbolicTopology::NumOfNodes() const {
+		return mdd_.NumOfNodes();
+	}
+
+	bool SymbolicTopology::Contains(const std::vector<std::string>& key) const {
+		std::vector<uint32_t> ids;
+		codec_.Decode(codec_.Encode(key), ids);
+		return mdd_.Contains(reachable_, ids);
+	}
+
+	/*
+	 * @brief Builds one event for the local moves of every resource and one for every (resource, transfer, partner).
+	 * The relations of a level are shared between the events that use them.
+	 */
+	void SymbolicTopology::BuildEvents() {
+		const std::vector<ResourceAutomaton>& automata = *automata_;
+		std::vector<std::vector<std::pair<size_t, size_t>>> events;
+		std::map<std::tuple<size_t, uint64_t, bool>, size_t> shared;
+
+		for (size_t i = 0; i < automata.size(); ++i) {
+			Mdd::LevelRelation local;
+			local.successors.resize(automata[i].NumOfStates());
+			std::vector<uint64_t> transfers;
+			for (uint32_t s = 0; s < automata[i].NumOfStates(); ++s) {
+				std::span<const uint32_t> targets = automata[i].targets(s);
+				std::span<const ParameterizedOp> labels = automata[i].labels(s);
+				for (size_t t = 0; t < targets.size(); ++t) {
+					if (labels[t].IsTransfer()) {
+						transfers.emplace_back(TransferIndex::Key(labels[t].transfer_type(), labels[t].transfer_n()));
+					} else {
+						local.successors[s].emplace_back(targets[t]);
+					}
+				}
+			}
+			if (!IsEmpty(local)) {
+				level_relations_.emplace_back(std::move(local));
+				events.push_back({ { i, level_relations_.size() - 1 } });
+			}
+
+			std::sort(transfers.begin(), transfers.end());
+			transfers.erase(std::unique(transfers.begin(), transfers.end()), transfers.end());
+			for (uint64_t key : transfers) {
+				TransferType type = static_cast<TransferType>(key & 1);
+				TransferType inverse = (type == TransferType::in) ? TransferType::out : TransferType::in;
+				size_t n = static_cast<size_t>(key >> 1);
+
+				Mdd::LevelRelation own;
+				own.successors.resize(automata[i].NumOfStates());
+				for (uint32_t s = 0; s < automata[i].NumOfStates(); ++s) {
+					std::span<const uint32_t> targets = automata[i].targets(s);
+					std::span<const ParameterizedOp> labels = automata[i].labels(s);
+					for (size_t t = 0; t < targets.size(); ++t) {
+						if (labels[t].IsTransfer() && labels[t].transfer_type() == type && labels[t].transfer_n() == n) {
+							own.successors[s].emplace_back(targets[t]);
+						}
+					}
+				}
+				level_relations_.emplace_back(std::move(own));
+				size_t own_idx = level_relations_.size() - 1;
+
+				// Relation of a candidate partner j, either taking the inverse transfer or, when it is a lower
+				// candidate than the actual partner, not offering it
+				auto partner_relation = [&](size_t j, bool offers) {
+					auto [it, inserted] = shared.try_emplace({ j, TransferIndex::Key(inverse, n), offers }, level_relations_.size());
+					if (inserted) {
+						Mdd::LevelRelation relation;
+						relation.successors.resize(automata[j].NumOfStates());
+						for (uint32_t s = 0; s < automata[j].NumOfStates(); ++s) {
+							std::optional<uint32_t> target = transfer_index_.Target(j, s, inverse, n);
+							if (offers && target.has_value()) {
+								relation.successors[s].emplace_back(*target);
+							} else if (!offers && !target.has_value()) {
+								relation.successors[s].emplace_back(s);
+							}
+						}
+						level_relations_.emplace_back(std::move(relation));
+					}
+					return it->second;
+				};
+
+				const std::vector<size_t>& candidates = transfer_index_.Resources(inverse, n);
+				for (size_t j : candidates) {
+					if (j == i) {
+						continue;
+					}
+					std::vector<std::pair<size_t, size_t>> event = { { i, own_idx }, { j, partner_relation(j, true) } };
+					for (size_t lower : candidates) {
+						if (lower >= j) {
+							break;
+						}
+						if (lower != i) {
+							event.emplace_back(lower, partner_relation(lower, false));
+						}
+					}
+					events.emplace_back(std::move(event));
+				}
+			}
+		}
+
+		for (const auto& event : events) {
+			Mdd::Relation relation;
+			relation.levels.assign(automata.size(), nullptr);
+			for (const auto& [level, idx] : event) {
+				relation.levels[level] = &level_relations_[idx];
+				relation.last_level = std::max(relation.last_level, level);
+			}
+			events_.emplace_back(std::move(relation));
+		}
+	}
+
+	/*
+	 * @brief Chained fixpoint: the image of every event is added to the reachable set as soon as it is computed
+	 */
+	void SymbolicTopology::Reach() {
+		std::vector<uint32_t> initial(automata_->size(), 0);
+		reachable_ = mdd_.Singleton(initial);
+		uint32_t previous;
+		do {
+			previous = reachable_;
+			for (const auto& event : events_) {
+				reachable_ = mdd_.Union(reachable_, mdd_.Image(reachable_, event));
+			}
+		} while (reachable_ != previous);
+	}
+
+	void SymbolicTopology::ExpandState(const std::vector<std::string>& key, const PackedState& packed_key) {
+		for (size_t i = 0; i < automata_->size(); ++i) {
+			const ResourceAutomaton& automaton = (*automata_)[i];
+			uint32_t local_state = codec_.Get(packed_key, i);
+			std::span<const uint32_t> targets = automaton.targets(local_state);
+			std::span<const ParameterizedOp> labels = automaton.labels(local_state);
+			for (size_t t = 0; t < targets.size(); ++t) {
+				if (labels[t].IsTransfer()) {
+					std::optional<PackedState> transfer_state = MatchingTransfer(transfer_index_, codec_, packed_key, i, labels[t], targets[t]);
+					if (!transfer_state.has_value()) {
+						continue;
+					}
+					topology_.AddTransition(key, std::make_pair(i, labels[t]), codec_.Names(*transfer_state));
+				} else {
+					std::vector<std::string> next_states = key;
+					next_states[i] = automaton.Name(targets[t]);
+					topology_.AddTransition(key, std::make_pair(i, labels[t]), next_states);
+				}
+			}
+		}
+	}
+
+}
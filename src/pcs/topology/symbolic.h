@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <unordered_set>
+
+#include <boost/container_hash/hash.hpp>
+
+#include "lts/lts.h"
+#include "pcs/topology/topology.h"
+#include "pcs/topology/core.h"
+#include "pcs/topology/mdd.h"
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/packed_state_set.h"
+#include "pcs/topology/state_codec.h"
+#include "pcs/topology/transfer_index.h"
+#include "pcs/topology/resource_automaton.h"
+
+namespace pcs {
+
+	/**
+	 * @brief Topology whose reachable states are computed symbolically as an MDD with one level per resource.
+	 *
+	 * The transition relation is partitioned into events that each touch few resources: the local moves of a resource,
+	 * and every transfer of a resource with each partner, guarded by the lower candidate partners not offering the
+	 * inverse so that the partner is the same one MatchingTransfer picks. Reachability is a fixpoint of image
+	 * computations over these events, no state is enumerated. at() expands only the states that are asked for and
+	 * lts() holds those, the same as IncrementalTopology.
+	 */
+	class SymbolicTopology : public ITopology {
+	private:
+		nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>> topology_;
+
+		std::shared_ptr<const std::vector<ResourceAutomaton>> automata_;
+		StateCodec codec_;
+		TransferIndex transfer_index_;
+
+		Mdd mdd_;
+		std::vector<Mdd::LevelRelation> level_relations_;
+		std::vector<Mdd::Relation> events_;
+		uint32_t reachable_ = Mdd::kEmpty;
+		PackedStateSet visited_;
+	public:
+		SymbolicTopology(const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss);
+		SymbolicTopology(std::shared_ptr<const std::vector<ResourceAutomaton>> automata);
+		const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& lts() const override;
+		operator const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& () const override;
+		const std::vector<std::string>& initial_state() const override;
+		const nightly::State<std::vector<std::string>, std::pair<size_t, ParameterizedOp>>& at(const std::vector<std::string>& key) override;
+
+		size_t NumOfStates() const override;
+		double NumOfReachableStates() const;
+		size_t NumOfNodes() const;
+		bool Contains(const std::vector<std::string>& key) const;
+	private:
+		void BuildEvents();
+		void Reach();
+		void ExpandState(const std::vector<std::string>& key, const PackedState& packed_key);
+	};
+
+}
@@ -0,0 +1,269 @@
+#include "pcs/topology/symmetry.h"
+
+#include <vector>
+#include <string>
+#include <span>
+#include <stack>
+#include <memory>
+#include <utility>
+#include <optional>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <stdexcept>
+
+#include "lts/lts.h"
+#include "pcs/topology/core.h"
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/state_codec.h"
+#include "pcs/topology/transfer_index.h"
+#include "pcs/topology/resource_automaton.h"
+
+namespace pcs {
+
+	namespace {
+
+		constexpr uint32_t kUnreachable = std::numeric_limits<uint32_t>::max();
+
+		/*
+		 * @brief Shape of a resource numbered in BFS order from its initial state, two resources are isomorphic iff
+		 * their signatures are equal.
+		 */
+		struct Signature {
+			std::vector<uint32_t> shape;
+			std::vector<const ParameterizedOp*> labels;
+
+			bool operator==(const Signature& other) const {
+				if (shape != other.shape || labels.size() != other.labels.size()) {
+					return false;
+				}
+				for (size_t i = 0; i < labels.size(); ++i) {
+					if (!(*labels[i] == *other.labels[i])) {
+						return false;
+					}
+				}
+				return true;
+			}
+		};
+
+	}
+
+	SymmetricTopology::SymmetricTopology(const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss)
+		: SymmetricTopology(CompileResources(ltss)) {}
+
+	SymmetricTopology::SymmetricTopology(std::shared_ptr<const std::vector<ResourceAutomaton>> automata)
+		: automata_(std::move(automata)), codec_(automata_), transfer_index_(*automata_) {
+		DetectClasses();
+		PackedState initial_packed(codec_.NumOfWords());
+		topology_.set_initial_state(codec_.Names(initial_packed));
+		lifted_.set_initial_state(codec_.Names(initial_packed));
+		Combine(initial_packed);
+	}
+
+	const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& SymmetricTopology::lts() const {
+		return topology_;
+	}
+
+	SymmetricTopology::operator const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& () const {
+		return topology_;
+	}
+
+	const std::vector<std::string>& SymmetricTopology::initial_state() const {
+		return topology_.initial_state();
+	}
+
+	/*
+	 * @brief Expands the concrete state key in the order of CompleteTopology, the partner of a transfer is the one
+	 * MatchingTransfer picks on key.
+	 * @exception Throws std::out_of_range if the class of key is not in the quotient
+	 */
+	const nightly::State<std::vector<std::string>, std::pair<size_t, ParameterizedOp>>& SymmetricTopology::at(const std::vector<std::string>& key) {
+		PackedState packed_key = codec_.Encode(key);
+		if (lifted_visited_.Contains(packed_key)) {
+			return lifted_.states().at(key);
+		}
+		if (!canonical_.Contains(Canonicalize(packed_key))) {
+			throw std::out_of_range("State is not in the topology");
+		}
+
+		for (size_t i = 0; i < automata_->size(); ++i) {
+			std::span<const ParameterizedOp> labels = (*automata_)[i].labels(codec_.Get(packed_key, i));
+			for (uint32_t t = 0; t < labels.size(); ++t) {
+				std::optional<PackedState> next_key = Successor(packed_key, i, t);
+				if (next_key.has_value()) {
+					lifted_.AddTransition(key, std::make_pair(i, labels[t]), codec_.Names(*next_key));
+				}
+			}
+		}
+		lifted_visited_.Insert(packed_key);
+		return lifted_.states().at(key);
+	}
+
+	const std::vector<std::vector<size_t>>& SymmetricTopology::classes() const {
+		return classes_;
+	}
+
+	/*
+	 * @brief Sorts the local states within every class of identical resources.
+	 * @param permutation: if given, permutation[i] is the resource of key whose local state ends up at resource i
+	 */
+	PackedState SymmetricTopology::Canonicalize(const PackedState& key, std::vector<size_t>* permutation) const {
+		PackedState canonical = key;
+		if (permutation != nullptr) {
+			permutation->resize(automata_->size());
+			std::iota(permutation->begin(), permutation->end(), 0);
+		}
+		std::vector<std::pair<uint32_t, size_t>> values;
+		for (const auto& members : classes_) {
+			values.clear();
+			for (size_t resource : members) {
+				values.emplace_back(to_canonical_[resource][codec_.Get(key, resource)], resource);
+			}
+			std::sort(values.begin(), values.end());
+			if (values.back().first == kUnreachable) {
+				continue;
+			}
+			for (size_t i = 0; i < members.size(); ++i) {
+				codec_.Set(canonical, members[i], from_canonical_[members[i]][values[i].first]);
+				if (permutation != nullptr) {
+					(*permutation)[members[i]] = values[i].second;
+				}
+			}
+		}
+		return canonical;
+	}
+
+	/*
+	 * @brief Numbers the reachable states of every resource in BFS order and groups the resources with equal signatures.
+	 * Transfer ids are part of the labels, resources are only interchangeable when they synchronise on the same ids.
+	 */
+	void SymmetricTopology::DetectClasses() {
+		size_t num_resources = automata_->size();
+		to_canonical_.resize(num_resources);
+		from_canonical_.resize(num_resources);
+		std::vector<Signature> signatures(num_resources);
+
+		for (size_t r = 0; r < num_resources; ++r) {
+			const ResourceAutomaton& automaton = (*automata_)[r];
+			std::vector<uint32_t>& to = to_canonical_[r];
+			std::vector<uint32_t>& from = from_canonical_[r];
+			to.assign(automaton.NumOfStates(), kUnreachable);
+			to[0] = 0;
+			from.emplace_back(0);
+			for (size_t q = 0; q < from.size(); ++q) {
+				std::span<const uint32_t> targets = automaton.targets(from[q]);
+				std::span<const ParameterizedOp> labels = automaton.labels(from[q]);
+				signatures[r].shape.emplace_back(static_cast<uint32_t>(targets.size()));
+				for (size_t t = 0; t < targets.size(); ++t) {
+					if (to[targets[t]] == kUnreachable) {
+						to[targets[t]] = static_cast<uint32_t>(from.size());
+						from.emplace_back(targets[t]);
+					}
+					signatures[r].shape.emplace_back(to[targets[t]]);
+					signatures[r].labels.emplace_back(&labels[t]);
+				}
+			}
+		}
+
+		std::vector<std::vector<size_t>> groups;
+		for (size_t r = 0; r < num_resources; ++r) {
+			auto it = std::find_if(groups.begin(), groups.end(),
+				[&](const std::vector<size_t>& group) { return signatures[group.front()] == signatures[r]; });
+			if (it == groups.end()) {
+				groups.push_back({ r });
+			} else {
+				it->emplace_back(r);
+			}
+		}
+		for (auto& group : groups) {
+			if (group.size() > 1) {
+				classes_.emplace_back(std::move(group));
+			}
+		}
+		class_of_.assign(num_resources, classes_.size());
+		for (size_t c = 0; c < classes_.size(); ++c) {
+			for (size_t resource : classes_[c]) {
+				class_of_[resource] = c;
+			}
+		}
+	}
+
+	std::optional<PackedState> SymmetricTopology::Successor(const PackedState& key, size_t resource, uint32_t transition) const {
+		uint32_t local_state = codec_.Get(key, resource);
+		const ResourceAutomaton& automaton = (*automata_)[resource];
+		const ParameterizedOp& label = automaton.labels(local_state)[transition];
+		uint32_t to = automaton.targets(local_state)[transition];
+		if (label.IsTransfer()) {
+			return MatchingTransfer(transfer_index_, codec_, key, resource, label, to);
+		}
+		PackedState next_key = key;
+		codec_.Set(next_key, resource, to);
+		return next_key;
+	}
+
+	/*
+	 * @brief The canonical successors of the canonical state key by a transition. A transfer synchronises with the
+	 * partner MatchingTransfer picks and with every resource in a class offering the inverse, since a permutation of
+	 * key can make that resource the lowest partner.
+	 */
+	std::vector<PackedState> SymmetricTopology::QuotientSuccessors(const PackedState& key, size_t resource, uint32_t transition) const {
+		std::vector<PackedState> successors;
+		const ResourceAutomaton& automaton = (*automata_)[resource];
+		const ParameterizedOp& label = automaton.labels(codec_.Get(key, resource))[transition];
+		if (!label.IsTransfer()) {
+			successors.emplace_back(Canonicalize(*Successor(key, resource, transition)));
+			return successors;
+		}
+		std::optional<size_t> lowest = MatchingTransferPartner(transfer_index_, codec_, key, resource, label);
+		if (!lowest.has_value()) {
+			return successors;
+		}
+		TransferType inverse = (label.transfer_type() == TransferType::in) ? TransferType::out : TransferType::in;
+		for (size_t partner : transfer_index_.Resources(inverse, label.transfer_n())) {
+			if (partner == resource || (partner != *lowest && class_of_[partner] == classes_.size())) {
+				continue;
+			}
+			std::optional<uint32_t> target = transfer_index_.Target(partner, codec_.Get(key, partner), inverse, label.transfer_n());
+			if (!target.has_value()) {
+				continue;
+			}
+			PackedState next_key = key;
+			codec_.Set(next_key, resource, automaton.targets(codec_.Get(key, resource))[transition]);
+			codec_.Set(next_key, partner, *target);
+			next_key = Canonicalize(next_key);
+			if (std::find(successors.begin(), successors.end(), next_key) == successors.end()) {
+				successors.emplace_back(std::move(next_key));
+			}
+		}
+		return successors;
+	}
+
+	/*
+	 * @brief Iterative DFS over canonical states, see QuotientSuccessors.
+	 */
+	void SymmetricTopology::Combine(const PackedState& initial_key) {
+		std::stack<PackedState> stack;
+		stack.push(initial_key);
+		std::vector<std::string> states_vec;
+
+		while (!stack.empty()) {
+			PackedState key = stack.top();
+			stack.pop();
+
+			if (!canonical_.Insert(key)) {
+				continue;
+			}
+			codec_.Decode(key, states_vec);
+			for (size_t i = 0; i < automata_->size(); ++i) {
+				std::span<const ParameterizedOp> labels = (*automata_)[i].labels(codec_.Get(key, i));
+				for (uint32_t t = 0; t < labels.size(); ++t) {
+					for (PackedState& canonical : QuotientSuccessors(key, i, t)) {
+						topology_.AddTransition(states_vec, std::make_pair(i, labels[t]), codec_.Names(canonical));
+						stack.push(std::move(canonical));
+					}
+				}
+			}
+		}
+	}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <unordered_set>
+#include <utility>
+#include <optional>
+#include <cstdint>
+
+#include <boost/container_hash/hash.hpp>
+
+#include "lts/lts.h"
+#include "pcs/topology/topology.h"
+#include "pcs/topology/core.h"
+#include "pcs/topology/packed_state.h"
+#include "pcs/topology/packed_state_set.h"
+#include "pcs/topology/state_codec.h"
+#include "pcs/topology/transfer_index.h"
+#include "pcs/topology/resource_automaton.h"
+
+namespace pcs {
+
+	/**
+	 * @brief Topology quotiented by the permutations of identical resources.
+	 *
+	 * Resources whose automata are isomorphic (same labels, same shape from the initial state) form a class, and a
+	 * topology state is canonical when the local states of each class are sorted. Only canonical states are explored
+	 * and stored, lts() is the quotient LTS. at() takes concrete states and expands them like CompleteTopology, so the
+	 * solvers see exactly the transitions CompleteTopology would give.
+	 *
+	 * MatchingTransfer picks the lowest partner of a transfer, and which resource of a class is lowest depends on the
+	 * permutation. A canonical state therefore takes every transfer with the MatchingTransfer partner and with every
+	 * partner in a class, so the quotient contains the class of every concrete state reachable in CompleteTopology;
+	 * it may also contain classes only reachable with a partner MatchingTransfer does not pick.
+	 */
+	class SymmetricTopology : public ITopology {
+	private:
+		// Quotient over canonical states
+		nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>> topology_;
+		// Concrete states handed out by at(), materialised on demand
+		nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>> lifted_;
+
+		std::shared_ptr<const std::vector<ResourceAutomaton>> automata_;
+		StateCodec codec_;
+		TransferIndex transfer_index_;
+
+		std::vector<std::vector<size_t>> classes_;
+		std::vector<std::vector<uint32_t>> to_canonical_;
+		std::vector<std::vector<uint32_t>> from_canonical_;
+
+		// Class of every resource, or classes_.size() for resources in no class
+		std::vector<size_t> class_of_;
+
+		PackedStateSet canonical_;
+		PackedStateSet lifted_visited_;
+	public:
+		SymmetricTopology(const std::vector<nightly::LTS<std::string, ParameterizedOp>>& ltss);
+		SymmetricTopology(std::shared_ptr<const std::vector<ResourceAutomaton>> automata);
+		const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& lts() const override;
+		operator const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& () const override;
+		const std::vector<std::string>& initial_state() const override;
+		const nightly::State<std::vector<std::string>, std::pair<size_t, ParameterizedOp>>& at(const std::vector<std::string>& key) override;
+
+		const std::vector<std::vector<size_t>>& classes() const;
+		PackedState Canonicalize(const PackedState& key, std::vector<size_t>* permutation = nullptr) const;
+	private:
+		void DetectClasses();
+		void Combine(const PackedState& initial_key);
+		std::optional<PackedState> Successor(const PackedState& key, size_t resource, uint32_t transition) const;
+		std::vector<PackedState> QuotientSuccessors(const PackedState& key, size_t resource, uint32_t transition) const;
+	};
+
+}
@@ -26,6 +26,21 @@ namespace pcs {
 		virtual const nightly::State<std::vector<std::string>, std::pair<size_t, ParameterizedOp>>& at(const std::vector<std::string>& key) = 0;
 
 		virtual operator const nightly::LTS<std::vector<std::string>, std::pair<size_t, ParameterizedOp>, boost::hash<std::vector<std::string>>>& () const = 0;
+
+		/*
+		 * @brief Number of states of the topology. By default the states of lts(), which for topologies expanded on
+		 * demand (IncrementalTopology, ClusteredTopology) are the states discovered so far
+		 */
+		virtual size_t NumOfStates() const {
+			return lts().NumOfStates();
+		}
+
+		/*
+		 * @brief Whether no recipe operation can ever be executed from the state, so solvers need not expand it
+		 */
+		virtual bool IsDead(const std::vector<std::string>& key) const {
+			return false;
+		}
 	};
 
 }
\ No newline at end of file
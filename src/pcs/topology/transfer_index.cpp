@@ -0,0 +1,69 @@
+#include "pcs/topology/transfer_index.h"
+
+#include <vector>
+#include <string>
+#include <span>
+#include <optional>
+#include <utility>
+#include <stdexcept>
+
+#include "pcs/topology/resource_automaton.h"
+#include "pcs/operation/parameterized_op.h"
+
+namespace pcs {
+
+	/*
+	 * @brief Only the first matching transition of a local state is indexed, which is the one the linear scan
+	 * in MatchingTransfer would have picked.
+	 * @exception Throws std::invalid_argument if a transfer number does not fit Key, i.e. is 2^63 or larger
+	 */
+	TransferIndex::TransferIndex(const std::vector<ResourceAutomaton>& automata)
+		: targets_(automata.size()) {
+		for (size_t i = 0; i < automata.size(); ++i) {
+			for (uint32_t local_state = 0; local_state < automata[i].NumOfStates(); ++local_state) {
+				std::span<const uint32_t> targets = automata[i].targets(local_state);
+				std::span<const ParameterizedOp> labels = automata[i].labels(local_state);
+				for (size_t t = 0; t < targets.size(); ++t) {
+					if (!labels[t].IsTransfer()) {
+						continue;
+					}
+					TransferType type = labels[t].transfer_type();
+					size_t n = labels[t].transfer_n();
+					if (n >> 63 != 0) {
+						throw std::invalid_argument("Transfer number " + std::to_string(n) + " is too large");
+					}
+					targets_[i].try_emplace(std::make_pair(local_state, Key(type, n)), targets[t]);
+					std::vector<size_t>& resources = resources_[Key(type, n)];
+					if (resources.empty() || resources.back() != i) {
+						resources.emplace_back(i);
+					}
+				}
+			}
+		}
+	}
+
+	std::optional<uint32_t> TransferIndex::Target(size_t resource, uint32_t local_state, TransferType type, size_t n) const {
+		auto it = targets_[resource].find(std::make_pair(local_state, Key(type, n)));
+		if (it == targets_[resource].end()) {
+			return {};
+		}
+		return it->second;
+	}
+
+	const std::vector<size_t>& TransferIndex::Resources(TransferType type, size_t n) const {
+		static const std::vector<size_t> none;
+		auto it = resources_.find(Key(type, n));
+		if (it == resources_.end()) {
+			return none;
+		}
+		return it->second;
+	}
+
+	/*
+	 * @brief Packs a transfer into one word, distinct for every n below 2^63
+	 */
+	uint64_t TransferIndex::Key(TransferType type, size_t n) {
+		return (static_cast<uint64_t>(n) << 1) | static_cast<uint64_t>(type);
+	}
+
+}
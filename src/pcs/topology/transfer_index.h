@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <cstdint>
+
+#include <boost/container_hash/hash.hpp>
+
+#include "pcs/operation/transfer.h"
+#include "pcs/topology/resource_automaton.h"
+
+namespace pcs {
+
+	/**
+	 * @brief Inverted index over the transfer transitions of every resource.
+	 *
+	 * Maps (resource, local state, transfer) to the local end-state of the first such transition, and each transfer
+	 * to the ascending list of resources that offer it anywhere. Finding the partner of a transfer is then a lookup per
+	 * candidate resource rather than a scan over the outgoing transitions of every resource.
+	 */
+	class TransferIndex {
+	private:
+		// Per resource, (local state, Key(type, n)) to the local end-state
+		std::vector<std::unordered_map<std::pair<uint32_t, uint64_t>, uint32_t, boost::hash<std::pair<uint32_t, uint64_t>>>> targets_;
+		std::unordered_map<uint64_t, std::vector<size_t>> resources_;
+	public:
+		TransferIndex() = default;
+		TransferIndex(const std::vector<ResourceAutomaton>& automata);
+
+		std::optional<uint32_t> Target(size_t resource, uint32_t local_state, TransferType type, size_t n) const;
+		const std::vector<size_t>& Resources(TransferType type, size_t n) const;
+
+		static uint64_t Key(TransferType type, size_t n);
+	};
+
+}
@@ -20,6 +20,39 @@ static pcs::Environment LoadPadMachine() {
 	return machine;
 }
 
+/*
+ * A resource that offers no operation of the pad recipe and no transfer
+ */
+static nightly::LTS<std::string, pcs::ParameterizedOp> UnrelatedResource() {
+	nightly::LTS<std::string, pcs::ParameterizedOp> unrelated;
+	unrelated.set_initial_state("s0");
+	unrelated.AddTransition("s0", pcs::ParameterizedOp("nop", pcs::Parameters()), "s0");
+	unrelated.AddTransition("s0", pcs::ParameterizedOp("paint", pcs::Parameters()), "s1");
+	unrelated.AddTransition("s1", pcs::ParameterizedOp("nop", pcs::Parameters()), "s1");
+	unrelated.AddTransition("s1", pcs::ParameterizedOp("dry", pcs::Parameters()), "s0");
+	return unrelated;
+}
+
+/*
+ * The controller with one more resource that stays in s0 and takes part in no transition
+ */
+static pcs::Controller::ControllerType WithIdleResource(const pcs::Controller::ControllerType& controller) {
+	auto extend = [](std::pair<std::string, std::vector<std::string>> state) {
+		state.second.emplace_back("s0");
+		return state;
+	};
+	pcs::Controller::ControllerType extended;
+	extended.set_initial_state(extend(controller.initial_state()));
+	for (const auto& [key, state] : controller.states()) {
+		for (const auto& transition : state.transitions_) {
+			std::vector<std::string> label = transition.label();
+			label.emplace_back("-");
+			extended.AddTransition(extend(key), label, extend(transition.to()));
+		}
+	}
+	return extended;
+}
+
 TEST(Controller, Pad) {
 	nightly::LTS<std::pair<std::string, std::vector<std::string>>, std::vector<std::string>, 
 		     boost::hash<std::pair<std::string,std::vector<std::string>>>> expected;
@@ -62,4 +95,229 @@ TEST(Controller, Pad_Incremental) {
 	ASSERT_EQ(opt.has_value(), true);
 	auto got = opt.value();
 	ASSERT_EQ(got, expected);
-}
\ No newline at end of file
+}
+TEST(Controller, Pad_Reduced) {
+	nightly::LTS<std::pair<std::string, std::vector<std::string>>, std::vector<std::string>,
+		boost::hash<std::pair<std::string, std::vector<std::string>>>> expected;
+	nightly::ReadFromFile(expected, "../../tests/controller/testdata/pad/controller.txt");
+
+	pcs::Environment machine = LoadPadMachine();
+	pcs::Recipe recipe;
+	try {
+		recipe.set_recipe("../../data/pad/recipe.json");
+	} catch (const std::ifstream::failure& e) {
+		throw;
+	}
+
+	machine.Reduced();
+	ASSERT_EQ(pcs::CompleteTopology(machine.resources()).lts().NumOfStates(), 444);
+	ASSERT_EQ(machine.NumOfTopologyStates(), 144);
+
+	pcs::Controller con(&machine, machine.topology(), &recipe);
+	auto opt = con.Generate();
+	ASSERT_EQ(opt.has_value(), true);
+	auto got = opt.value();
+	ASSERT_EQ(got, expected);
+}
+
+TEST(Controller, Pad_Frozen) {
+	nightly::LTS<std::pair<std::string, std::vector<std::string>>, std::vector<std::string>,
+		boost::hash<std::pair<std::string, std::vector<std::string>>>> expected;
+	nightly::ReadFromFile(expected, "../../tests/controller/testdata/pad/controller.txt");
+
+	pcs::Environment machine = LoadPadMachine();
+	pcs::Recipe recipe;
+	try {
+		recipe.set_recipe("../../data/pad/recipe.json");
+	} catch (const std::ifstream::failure& e) {
+		throw;
+	}
+
+	machine.Complete();
+	size_t num_of_states = machine.NumOfTopologyStates();
+	machine.Freeze();
+	ASSERT_EQ(machine.NumOfTopologyStates(), num_of_states);
+
+	pcs::Controller con(&machine, machine.topology(), &recipe);
+	auto opt = con.Generate();
+	ASSERT_EQ(opt.has_value(), true);
+	auto got = opt.value();
+	ASSERT_EQ(got, expected);
+}
+
+TEST(Controller, Pad_Pruned) {
+	nightly::LTS<std::pair<std::string, std::vector<std::string>>, std::vector<std::string>,
+		boost::hash<std::pair<std::string, std::vector<std::string>>>> expected;
+	nightly::ReadFromFile(expected, "../../tests/controller/testdata/pad/controller.txt");
+
+	pcs::Environment machine = LoadPadMachine();
+	pcs::Recipe recipe;
+	try {
+		recipe.set_recipe("../../data/pad/recipe.json");
+	} catch (const std::ifstream::failure& e) {
+		throw;
+	}
+
+	machine.Complete();
+	pcs::PruneReport report = machine.Prune(recipe);
+	ASSERT_EQ(report.num_states, pcs::CompleteTopology(machine.resources()).lts().NumOfStates());
+	ASSERT_LE(report.num_dead_states, report.num_states);
+	ASSERT_FALSE(machine.topology()->IsDead(machine.topology()->initial_state()));
+
+	pcs::Controller con(&machine, machine.topology(), &recipe);
+	auto opt = con.Generate();
+	ASSERT_EQ(opt.has_value(), true);
+	auto got = opt.value();
+	ASSERT_EQ(got, expected);
+}
+
+TEST(Controller, Pad_Minimised) {
+	nightly::LTS<std::pair<std::string, std::vector<std::string>>, std::vector<std::string>,
+		boost::hash<std::pair<std::string, std::vector<std::string>>>> expected;
+	nightly::ReadFromFile(expected, "../../tests/controller/testdata/pad/controller.txt");
+
+	pcs::Environment machine = LoadPadMachine();
+	pcs::Recipe recipe;
+	try {
+		recipe.set_recipe("../../data/pad/recipe.json");
+	} catch (const std::ifstream::failure& e) {
+		throw;
+	}
+
+	machine.Minimise();
+	machine.Complete();
+	// States s1 and s3 of Resource5 only offer out:2 to s0, so they are merged
+	const pcs::ResourceAutomaton& resource5 = (*machine.automata())[4];
+	ASSERT_EQ(resource5.NumOfStates(), 4);
+	ASSERT_EQ(resource5.Id("s1"), resource5.Id("s3"));
+	ASSERT_EQ(pcs::CompleteTopology(machine.resources()).lts().NumOfStates(), 444);
+	ASSERT_EQ(machine.NumOfTopologyStates(), 420);
+
+	// Controller states are renamed from the merged states back to the states the resources pass through
+	pcs::Controller con(&machine, machine.topology(), &recipe);
+	auto opt = con.Generate();
+	ASSERT_EQ(opt.has_value(), true);
+	auto got = opt.value();
+	ASSERT_EQ(got, expected);
+}
+
+TEST(Controller, Pad_Recipe) {
+	nightly::LTS<std::pair<std::string, std::vector<std::string>>, std::vector<std::string>,
+		boost::hash<std::pair<std::string, std::vector<std::string>>>> expected;
+	nightly::ReadFromFile(expected, "../../tests/controller/testdata/pad/controller.txt");
+
+	pcs::Environment machine = LoadPadMachine();
+	pcs::Recipe recipe;
+	try {
+		recipe.set_recipe("../../data/pad/recipe.json");
+	} catch (const std::ifstream::failure& e) {
+		throw;
+	}
+
+	// Every operation of the unrelated resource is dropped, so it stays in its initial state
+	machine.AddResource(UnrelatedResource());
+	ASSERT_EQ(pcs::CompleteTopology(machine.resources()).lts().NumOfStates(), 888);
+	machine.ComputeTopology(recipe);
+	ASSERT_EQ(machine.NumOfTopologyStates(), 444);
+
+	pcs::Controller con(&machine, machine.topology(), &recipe);
+	auto opt = con.Generate();
+	ASSERT_EQ(opt.has_value(), true);
+	auto got = opt.value();
+	ASSERT_EQ(got, WithIdleResource(expected));
+}
+
+TEST(Controller, Pad_Projection) {
+	pcs::Environment machine = LoadPadMachine();
+
+	machine.ComputeTopology({ 2, 0 });
+	pcs::ITopology* projection = machine.topology();
+	ASSERT_EQ(machine.NumOfTopologyStates(), 2);
+	for (const auto& [key, state] : projection->lts().states()) {
+		for (size_t i = 0; i < machine.resources().size(); ++i) {
+			if (i != 0 && i != 2) {
+				ASSERT_EQ(key[i], machine.resources()[i].initial_state());
+			}
+		}
+	}
+
+	machine.ComputeTopology({ 0, 2, 2 });
+	ASSERT_EQ(machine.topology(), projection);
+}
+
+TEST(Controller, Pad_ConeOfInfluence) {
+	nightly::LTS<std::pair<std::string, std::vector<std::string>>, std::vector<std::string>,
+		boost::hash<std::pair<std::string, std::vector<std::string>>>> expected;
+	nightly::ReadFromFile(expected, "../../tests/controller/testdata/pad/controller.txt");
+
+	pcs::Environment machine = LoadPadMachine();
+	pcs::Recipe recipe;
+	try {
+		recipe.set_recipe("../../data/pad/recipe.json");
+	} catch (const std::ifstream::failure& e) {
+		throw;
+	}
+	size_t num_of_states = pcs::CompleteTopology(machine.resources()).lts().NumOfStates();
+
+	// Offers no operation of the recipe and no transfer
+	machine.AddResource(UnrelatedResource());
+	std::vector<size_t> relevant = machine.ConeOfInfluence(recipe);
+	ASSERT_EQ(relevant, std::vector<size_t>({ 0, 1, 2, 3, 4 }));
+
+	// The recipe topology and the projections hold the unrelated resource idle as well
+	machine.ComputeTopology({ 0, 5 });
+	size_t num_of_projected = machine.NumOfTopologyStates();
+	machine.ComputeTopology({ 0 });
+	ASSERT_EQ(machine.NumOfTopologyStates(), num_of_projected);
+	machine.ComputeTopology(recipe);
+	ASSERT_EQ(machine.NumOfTopologyStates(), num_of_states);
+
+	machine.Complete();
+	ASSERT_EQ(machine.NumOfTopologyStates(), num_of_states);
+	for (const auto& [key, state] : machine.topology()->lts().states()) {
+		ASSERT_EQ(key[5], "s0");
+	}
+
+	pcs::Controller con(&machine, machine.topology(), &recipe);
+	auto opt = con.Generate();
+	ASSERT_EQ(opt.has_value(), true);
+	auto got = opt.value();
+	ASSERT_EQ(got, WithIdleResource(expected));
+}
+
+TEST(Controller, Pad_Clustered) {
+	nightly::LTS<std::pair<std::string, std::vector<std::string>>, std::vector<std::string>,
+		boost::hash<std::pair<std::string, std::vector<std::string>>>> expected;
+	nightly::ReadFromFile(expected, "../../tests/controller/testdata/pad/controller.txt");
+
+	pcs::Environment machine = LoadPadMachine();
+	pcs::Recipe recipe;
+	try {
+		recipe.set_recipe("../../data/pad/recipe.json");
+	} catch (const std::ifstream::failure& e) {
+		throw;
+	}
+
+	machine.Clustered({ { 0, 1, 2 }, { 3, 4 } });
+	auto products = dynamic_cast<pcs::ClusteredTopology*>(machine.topology())->products();
+
+	pcs::Controller con(&machine, machine.topology(), &recipe);
+	auto opt = con.Generate();
+	ASSERT_EQ(opt.has_value(), true);
+	auto got = opt.value();
+	ASSERT_EQ(got, expected);
+
+	// Unchanged clusters keep their explored products
+	machine.Clustered({ { 0, 1, 2 }, { 3 }, { 4 } });
+	ASSERT_EQ(dynamic_cast<pcs::ClusteredTopology*>(machine.topology())->products()[0], products[0]);
+}
+
+TEST(Controller, Pad_AutoTopology) {
+	pcs::Environment machine = LoadPadMachine();
+	size_t num_of_states = pcs::CompleteTopology(machine.resources()).lts().NumOfStates();
+
+	ASSERT_EQ(machine.AutoTopology(), pcs::TopologyStrategy::complete);
+	ASSERT_EQ(machine.NumOfTopologyStates(), num_of_states);
+	ASSERT_EQ(machine.AutoTopology(0), pcs::TopologyStrategy::incremental);
+	ASSERT_EQ(machine.NumOfTopologyStates(), 1);
+}
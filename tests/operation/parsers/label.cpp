@@ -8,6 +8,7 @@
 #include "pcs/operation/transfer.h"
 #include "pcs/operation/nop.h"
 #include "pcs/operation/observable.h"
+#include "pcs/operation/parameterized_op.h"
 
 TEST(OperationLabelParser, SyncIn) {
 	std::string label = "in:5";
@@ -39,4 +40,71 @@ TEST(OperationLabelParser, Nop) {
 	std::unique_ptr<pcs::IOperation> got = pcs::StringToOperation(label);
 	pcs::Nop* got_op = dynamic_cast<pcs::Nop*>(got.get());
 	ASSERT_EQ(*got_op, expected);
-}
\ No newline at end of file
+}
+
+TEST(OperationLabelParser, Classify) {
+	pcs::LabelClass in = pcs::ClassifyLabel("in:5");
+	ASSERT_EQ(in.kind, pcs::LabelKind::transfer);
+	ASSERT_EQ(in.transfer_type, pcs::TransferType::in);
+	ASSERT_EQ(in.transfer_n, 5);
+	pcs::LabelClass out = pcs::ClassifyLabel("out:12");
+	ASSERT_EQ(out.kind, pcs::LabelKind::transfer);
+	ASSERT_EQ(out.transfer_type, pcs::TransferType::out);
+	ASSERT_EQ(out.transfer_n, 12);
+	ASSERT_EQ(pcs::ClassifyLabel("nop").kind, pcs::LabelKind::nop);
+	ASSERT_EQ(pcs::ClassifyLabel("drill").kind, pcs::LabelKind::observable);
+
+	// Only an exact prefix followed by a number is a transfer
+	ASSERT_EQ(pcs::ClassifyLabel("login:x").kind, pcs::LabelKind::observable);
+	ASSERT_EQ(pcs::ClassifyLabel("checkout:3").kind, pcs::LabelKind::observable);
+	ASSERT_EQ(pcs::ClassifyLabel("in:x").kind, pcs::LabelKind::observable);
+	ASSERT_EQ(pcs::ClassifyLabel("in:").kind, pcs::LabelKind::observable);
+	ASSERT_EQ(pcs::ClassifyLabel("out:3a").kind, pcs::LabelKind::observable);
+	ASSERT_EQ(pcs::ClassifyLabel("out:99999999999999999999999").kind, pcs::LabelKind::observable);
+	ASSERT_NO_THROW(pcs::ParameterizedOp("login:x", pcs::Parameters()));
+}
+
+TEST(OperationLabelParser, ParameterizedOpKind) {
+	pcs::ParameterizedOp op("out:3", pcs::Parameters());
+	ASSERT_TRUE(op.IsTransfer());
+	ASSERT_EQ(op.transfer(), pcs::TransferOperation(pcs::TransferType::out, 3));
+	op.set_operation("nop");
+	ASSERT_TRUE(op.IsNop());
+	pcs::ParameterizedOp copy = op;
+	ASSERT_TRUE(copy.IsNop());
+	copy.set_operation("drill");
+	ASSERT_TRUE(copy.IsObservable());
+}
+
+TEST(OperationLabelParser, Interned) {
+	pcs::Parameters parameters;
+	parameters.map().emplace("size", "4");
+	pcs::ParameterizedOp a("drill", parameters);
+	pcs::ParameterizedOp b("drill", parameters);
+	pcs::ParameterizedOp c("drill", pcs::Parameters());
+	ASSERT_EQ(a, b);
+	ASSERT_EQ(a.id(), b.id());
+	ASSERT_NE(a.id(), c.id());
+	ASSERT_EQ(a.operation_id(), c.operation_id());
+	ASSERT_EQ(a.operation_id(), pcs::ParameterizedOp::OperationId("drill"));
+	ASSERT_EQ(a.parameters(), parameters);
+
+	c.set_parameters(parameters);
+	ASSERT_EQ(a, c);
+}
+
+TEST(OperationLabelParser, Released) {
+	const size_t num_labels = pcs::LabelTable::Global().NumOfLabels();
+	ASSERT_EQ(pcs::ParameterizedOp::OperationId("released_op"), pcs::LabelTable::kUnknownOperation);
+	ASSERT_EQ(pcs::LabelTable::Global().NumOfLabels(), num_labels);
+	{
+		pcs::ParameterizedOp a("released_op", pcs::Parameters());
+		pcs::ParameterizedOp b = a;
+		ASSERT_EQ(pcs::LabelTable::Global().NumOfLabels(), num_labels + 1);
+		ASSERT_EQ(pcs::ParameterizedOp::OperationId("released_op"), a.operation_id());
+		a.set_operation("drill");
+		ASSERT_EQ(pcs::ParameterizedOp::OperationId("released_op"), b.operation_id());
+	}
+	ASSERT_EQ(pcs::LabelTable::Global().NumOfLabels(), num_labels);
+	ASSERT_EQ(pcs::ParameterizedOp::OperationId("released_op"), pcs::LabelTable::kUnknownOperation);
+}
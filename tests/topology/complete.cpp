@@ -1,8 +1,31 @@
 #include <gtest/gtest.h>
 #include "pcs/topology/complete.h"
+#include "pcs/topology/symmetry.h"
+#include "pcs/topology/reduced.h"
+#include "pcs/topology/frozen.h"
+#include "pcs/topology/snapshot.h"
+#include "pcs/topology/symbolic.h"
+#include "pcs/topology/external.h"
+#include "pcs/topology/successors.h"
+#include "pcs/topology/clustered.h"
+#include "pcs/topology/estimator.h"
+#include "pcs/topology/bitstate.h"
+#include "pcs/topology/distributed.h"
 
 #include <array>
 #include <string>
+#include <filesystem>
+#include <queue>
+#include <unordered_set>
+#include <stdexcept>
+#include <memory>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <cstring>
+#include <cstddef>
+#include <thread>
+#include <future>
 
 #include "lts/lts.h"
 #include "lts/state.h"
@@ -10,6 +33,17 @@
 #include "lts/writers.h"
 
 
+static std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>> LoadPad() {
+	std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>> ltss;
+	ltss.resize(5);
+	nightly::ReadFromFile(ltss[0], "../../data/pad/Resource1.txt");
+	nightly::ReadFromFile(ltss[1], "../../data/pad/Resource2.txt");
+	nightly::ReadFromFile(ltss[2], "../../data/pad/Resource3.txt");
+	nightly::ReadFromFile(ltss[3], "../../data/pad/Resource4.txt");
+	nightly::ReadFromFile(ltss[4], "../../data/pad/Resource5.txt");
+	return ltss;
+}
+
 TEST(CompleteTopology, IterativeRecursive) {
 	std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>> ltss;
 	ltss.resize(5);
@@ -79,4 +113,465 @@ TEST(CompleteTopology, MergeWithTransferOps) {
 	pcs::CompleteTopology ct(ltss);
 	got = ct.lts();
 	ASSERT_EQ(expected, got);
-}
\ No newline at end of file
+}
+
+TEST(CompleteTopology, Parallel) {
+	std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>> ltss = LoadPad();
+
+	pcs::CompleteTopology serial(ltss);
+	for (size_t num_threads : { 2, 4, 8 }) {
+		pcs::CompleteTopology parallel(ltss, false, num_threads);
+		ASSERT_EQ(serial.lts(), parallel.lts());
+	}
+}
+
+TEST(SymmetricTopology, IdenticalResources) {
+	std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>> ltss;
+	ltss.resize(4);
+	for (auto& lts : ltss) {
+		nightly::ReadFromFile(lts, "../../data/pad/Resource1.txt");
+	}
+
+	pcs::CompleteTopology complete(ltss);
+	pcs::SymmetricTopology symmetric(ltss);
+	ASSERT_EQ(symmetric.classes().size(), 1);
+	ASSERT_EQ(symmetric.classes()[0].size(), 4);
+	ASSERT_LT(symmetric.lts().NumOfStates(), complete.lts().NumOfStates());
+
+	for (const auto& [key, state] : complete.lts().states()) {
+		if (state.transitions_.empty()) {
+			continue;
+		}
+		const auto& lifted = symmetric.at(key);
+		ASSERT_EQ(lifted.transitions_.size(), state.transitions_.size());
+		for (size_t i = 0; i < state.transitions_.size(); ++i) {
+			ASSERT_EQ(lifted.transitions_[i].label(), state.transitions_[i].label());
+			ASSERT_EQ(lifted.transitions_[i].to(), state.transitions_[i].to());
+		}
+	}
+}
+
+TEST(SymmetricTopology, TransferPartners) {
+	// Resources 2 and 3 are identical and offer in:1 from s0 and from s2, MatchingTransfer picks the lower one.
+	// Resource 0 always offers out:1, so it is the partner of every in:1 they start themselves.
+	std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>> ltss(4);
+	ltss[0].set_initial_state("z");
+	ltss[0].AddTransition("z", pcs::ParameterizedOp("out:1", pcs::Parameters()), "z");
+	ltss[1].set_initial_state("a");
+	ltss[1].AddTransition("a", pcs::ParameterizedOp("out:1", pcs::Parameters()), "b");
+	for (size_t i = 2; i < ltss.size(); ++i) {
+		ltss[i].set_initial_state("s0");
+		ltss[i].AddTransition("s0", pcs::ParameterizedOp("in:1", pcs::Parameters()), "s1");
+		ltss[i].AddTransition("s0", pcs::ParameterizedOp("x", pcs::Parameters()), "s2");
+		ltss[i].AddTransition("s2", pcs::ParameterizedOp("in:1", pcs::Parameters()), "s3");
+	}
+
+	pcs::CompleteTopology complete(ltss);
+	pcs::SymmetricTopology symmetric(ltss);
+	pcs::StateCodec codec(ltss);
+	ASSERT_EQ(symmetric.classes(), (std::vector<std::vector<size_t>>{ { 2, 3 } }));
+	ASSERT_LT(symmetric.lts().NumOfStates(), complete.lts().NumOfStates());
+
+	// In (z, a, s2, s0) the out:1 of resource 1 picks resource 2 in s2, no canonical state reaches the class of its successor
+	const auto& states = complete.lts().states();
+	ASSERT_NE(states.find(std::vector<std::string>{ "z", "b", "s3", "s0" }), states.end());
+	for (const auto& [key, state] : states) {
+		std::vector<std::string> canonical = codec.Names(symmetric.Canonicalize(codec.Encode(key)));
+		ASSERT_NE(symmetric.lts().states().find(canonical), symmetric.lts().states().end());
+		if (state.transitions_.empty()) {
+			continue;
+		}
+		const auto& lifted = symmetric.at(key);
+		ASSERT_EQ(lifted.transitions_.size(), state.transitions_.size());
+		for (size_t i = 0; i < state.transitions_.size(); ++i) {
+			ASSERT_EQ(lifted.transitions_[i].label(), state.transitions_[i].label());
+			ASSERT_EQ(lifted.transitions_[i].to(), state.transitions_[i].to());
+		}
+	}
+}
+
+TEST(ReducedTopology, KeepsBothHalvesOfTransfers) {
+	// Resource 2 cannot idle, its out:1 synchronises with resource 1, whose own lowest out:1 partner is resource 0
+	std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>> ltss(3);
+	for (size_t i = 0; i < ltss.size(); ++i) {
+		ltss[i].set_initial_state("s0");
+		if (i != 2) {
+			ltss[i].AddTransition("s0", pcs::ParameterizedOp("nop", pcs::Parameters()), "s0");
+		}
+		ltss[i].AddTransition("s0", pcs::ParameterizedOp(i == 1 ? "in:1" : "out:1", pcs::Parameters()), "s1");
+		ltss[i].AddTransition("s1", pcs::ParameterizedOp("nop", pcs::Parameters()), "s1");
+	}
+	pcs::ReducedTopology topology(ltss);
+
+	std::vector<size_t> resources;
+	for (const auto& transition : topology.at(topology.initial_state()).transitions_) {
+		if (transition.label().second.IsTransfer()) {
+			resources.emplace_back(transition.label().first);
+			// Both halves move resources 1 and 2, the idle resource 0 stays put
+			ASSERT_EQ(transition.to(), (std::vector<std::string>{ "s0", "s1", "s1" }));
+		}
+	}
+	std::sort(resources.begin(), resources.end());
+	ASSERT_EQ(resources, (std::vector<size_t>{ 1, 2 }));
+}
+
+TEST(FrozenTopology, Freeze) {
+	std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>> ltss = LoadPad();
+
+	pcs::CompleteTopology complete(ltss);
+	std::unique_ptr<pcs::FrozenTopology> frozen = complete.Freeze();
+	ASSERT_EQ(frozen->NumOfTransitions(), complete.lts().NumOfTransitions());
+	ASSERT_EQ(frozen->Key(0), complete.initial_state());
+
+	const auto& state = frozen->at(complete.initial_state());
+	const auto& expected = complete.at(complete.initial_state());
+	ASSERT_EQ(state.transitions_.size(), expected.transitions_.size());
+	for (size_t i = 0; i < state.transitions_.size(); ++i) {
+		ASSERT_EQ(state.transitions_[i].label(), expected.transitions_[i].label());
+		ASSERT_EQ(state.transitions_[i].to(), expected.transitions_[i].to());
+	}
+	ASSERT_EQ(frozen->lts(), complete.lts());
+}
+
+TEST(FrozenTopology, DeltaStates) {
+	std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>> ltss = LoadPad();
+
+	pcs::CompleteTopology complete(ltss);
+	std::unique_ptr<pcs::FrozenTopology> full = complete.Freeze();
+	std::unique_ptr<pcs::FrozenTopology> delta = complete.Freeze(8);
+	ASSERT_EQ(full->states().NumOfCheckpoints(), full->NumOfStates());
+	// Pad states take one word, so a delta entry would cost more than the state and every state is stored in full
+	ASSERT_EQ(delta->codec().NumOfWords(), 1);
+	ASSERT_FALSE(delta->states().IsDelta());
+	ASSERT_EQ(delta->states().NumOfCheckpoints(), delta->NumOfStates());
+	// A vector of PackedStates plus an unordered_map index, counting one pointer per node and per bucket
+	size_t vector_map = full->NumOfStates() * (2 * sizeof(pcs::PackedState) + sizeof(uint32_t) + 2 * sizeof(void*));
+	ASSERT_LT(full->states().MemoryUsage(), vector_map);
+
+	for (uint32_t id = 0; id < full->NumOfStates(); ++id) {
+		std::vector<std::string> key = full->Key(id);
+		ASSERT_EQ(delta->Key(id), key);
+		ASSERT_EQ(delta->Id(key), id);
+		// The Zobrist hash does not depend on how the state is encoded
+		ASSERT_EQ(delta->states().Hash(id), full->states().Hash(id));
+	}
+	ASSERT_EQ(delta->lts(), complete.lts());
+	ASSERT_THROW(delta->Id(std::vector<std::string>(5, "missing")), std::out_of_range);
+}
+
+TEST(FrozenTopology, Prune) {
+	std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>> ltss = LoadPad();
+
+	pcs::CompleteTopology complete(ltss);
+	std::unique_ptr<pcs::FrozenTopology> frozen = complete.Freeze();
+	pcs::PruneReport report = frozen->Prune({ pcs::ParameterizedOp::OperationId("load") });
+	ASSERT_EQ(report.num_states, frozen->NumOfStates());
+	ASSERT_EQ(report.num_transitions, frozen->NumOfTransitions());
+
+	// Dead states are closed under successors and the dead transitions are the ones into them
+	size_t num_dead_transitions = 0;
+	for (uint32_t id = 0; id < frozen->NumOfStates(); ++id) {
+		bool dead = frozen->IsDead(frozen->Key(id));
+		for (const auto& edge : frozen->edges(id)) {
+			bool dead_to = frozen->IsDead(frozen->Key(edge.to));
+			ASSERT_TRUE(!dead || dead_to);
+			num_dead_transitions += dead_to ? 1 : 0;
+		}
+	}
+	ASSERT_EQ(num_dead_transitions, report.num_dead_transitions);
+	ASSERT_FALSE(frozen->IsDead(frozen->Key(0)));
+
+	// Nothing is reachable from a never executed operation
+	report = frozen->Prune({ pcs::ParameterizedOp::OperationId("no_such_operation") });
+	ASSERT_EQ(report.num_dead_states, report.num_states);
+}
+
+TEST(MappedTopology, Snapshot) {
+	std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>> ltss;
+	ltss.resize(3);
+	nightly::ReadFromFile(ltss[0], "../../data/pad/Resource1.txt");
+	nightly::ReadFromFile(ltss[1], "../../data/pad/Resource2.txt");
+	nightly::ReadFromFile(ltss[2], "../../data/pad/Resource3.txt");
+
+	auto automata = pcs::CompileResources(ltss);
+	pcs::CompleteTopology complete(automata);
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "pcs_mapped_topology_snapshot.pcst";
+	pcs::SaveSnapshot(*complete.Freeze(), path);
+
+	{
+		pcs::MappedTopology mapped(path, automata);
+		ASSERT_EQ(mapped.resources_hash(), pcs::ResourcesHash(*automata));
+		ASSERT_EQ(mapped.NumOfTransitions(), complete.lts().NumOfTransitions());
+		ASSERT_EQ(mapped.initial_state(), complete.initial_state());
+		for (const auto& [key, state] : complete.lts().states()) {
+			const auto& expected = complete.at(key);
+			const auto& got = mapped.at(key);
+			ASSERT_EQ(got.transitions_.size(), expected.transitions_.size());
+			for (size_t i = 0; i < got.transitions_.size(); ++i) {
+				ASSERT_EQ(got.transitions_[i].label(), expected.transitions_[i].label());
+				ASSERT_EQ(got.transitions_[i].to(), expected.transitions_[i].to());
+			}
+		}
+		ASSERT_EQ(mapped.lts(), complete.lts());
+	}
+
+	// An edge to a state past the end is rejected when opening rather than read through when followed
+	std::string bytes;
+	{
+		std::ifstream is(path, std::ios::binary);
+		bytes.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+	}
+	pcs::SnapshotHeader header;
+	std::memcpy(&header, bytes.data(), sizeof(header));
+	size_t sorted_size = header.num_states * sizeof(uint32_t);
+	size_t edges_begin = sizeof(header) + header.num_states * header.num_words * sizeof(uint64_t) + sorted_size + (8 - sorted_size % 8) % 8
+		               + (header.num_states + 1) * sizeof(uint64_t);
+	uint32_t to = static_cast<uint32_t>(header.num_states);
+	std::memcpy(bytes.data() + edges_begin + offsetof(pcs::FrozenTopology::Edge, to), &to, sizeof(to));
+	std::filesystem::path corrupt = std::filesystem::temp_directory_path() / "pcs_mapped_topology_corrupt.pcst";
+	{
+		std::ofstream os(corrupt, std::ios::binary);
+		os.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+	}
+	ASSERT_THROW(pcs::MappedTopology(corrupt, automata), std::runtime_error);
+	std::filesystem::remove(corrupt);
+
+	ltss.pop_back();
+	ASSERT_THROW(pcs::MappedTopology(path, pcs::CompileResources(ltss)), std::runtime_error);
+	std::filesystem::remove(path);
+}
+
+TEST(SymbolicTopology, Reachability) {
+	std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>> ltss = LoadPad();
+
+	pcs::CompleteTopology complete(ltss);
+	pcs::SymbolicTopology symbolic(ltss);
+	ASSERT_EQ(symbolic.NumOfReachableStates(), static_cast<double>(complete.lts().NumOfStates()));
+	// Counted from the MDD, not from the states expanded so far
+	ASSERT_EQ(symbolic.NumOfStates(), complete.lts().NumOfStates());
+	ASSERT_EQ(symbolic.lts().NumOfStates(), 1);
+	for (const auto& [key, state] : complete.lts().states()) {
+		ASSERT_TRUE(symbolic.Contains(key));
+		const auto& expected = complete.at(key);
+		const auto& got = symbolic.at(key);
+		ASSERT_EQ(got.transitions_.size(), expected.transitions_.size());
+		for (size_t i = 0; i < got.transitions_.size(); ++i) {
+			ASSERT_EQ(got.transitions_[i].label(), expected.transitions_[i].label());
+			ASSERT_EQ(got.transitions_[i].to(), expected.transitions_[i].to());
+		}
+	}
+}
+
+TEST(SymbolicTopology, ManyResources) {
+	std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>> ltss;
+	ltss.resize(4);
+	nightly::ReadFromFile(ltss[0], "../../data/pad/Resource1.txt");
+	nightly::ReadFromFile(ltss[1], "../../data/pad/Resource2.txt");
+	nightly::ReadFromFile(ltss[2], "../../data/pad/Resource3.txt");
+	nightly::ReadFromFile(ltss[3], "../../data/pad/Resource4.txt");
+	double num_of_states = static_cast<double>(pcs::CompleteTopology(ltss).lts().NumOfStates());
+
+	// 20 independent three-state resources multiply the state space by 3^20
+	ltss.resize(24);
+	for (size_t i = 4; i < ltss.size(); ++i) {
+		nightly::ReadFromFile(ltss[i], "../../tests/topology/testdata/lts1.txt");
+		num_of_states *= 3;
+	}
+
+	pcs::SymbolicTopology symbolic(ltss);
+	ASSERT_EQ(symbolic.NumOfReachableStates(), num_of_states);
+	ASSERT_TRUE(symbolic.Contains(symbolic.initial_state()));
+	const auto& state = symbolic.at(symbolic.initial_state());
+	for (const auto& transition : state.transitions_) {
+		ASSERT_TRUE(symbolic.Contains(transition.to()));
+	}
+}
+
+TEST(ExternalTopology, MatchesComplete) {
+	std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>> ltss = LoadPad();
+
+	auto automata = pcs::CompileResources(ltss);
+	pcs::CompleteTopology complete(automata);
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "pcs_external_topology.pcst";
+	// A tiny budget forces many sorted runs per level, merged two at a time over several passes
+	pcs::BuildExternalTopology(automata, path, 4096, 2);
+	ASSERT_FALSE(std::filesystem::exists(path.string() + ".work"));
+
+	{
+		pcs::MappedTopology mapped(path, automata);
+		ASSERT_EQ(mapped.NumOfStates(), complete.lts().NumOfStates());
+		ASSERT_EQ(mapped.NumOfTransitions(), complete.lts().NumOfTransitions());
+		ASSERT_EQ(mapped.initial_state(), complete.initial_state());
+		const auto& state = mapped.at(complete.initial_state());
+		const auto& expected = complete.at(complete.initial_state());
+		ASSERT_EQ(state.transitions_.size(), expected.transitions_.size());
+		for (size_t i = 0; i < state.transitions_.size(); ++i) {
+			ASSERT_EQ(state.transitions_[i].label(), expected.transitions_[i].label());
+			ASSERT_EQ(state.transitions_[i].to(), expected.transitions_[i].to());
+		}
+		ASSERT_EQ(mapped.lts(), complete.lts());
+	}
+	std::filesystem::remove(path);
+}
+
+TEST(SuccessorGenerator, MatchesComplete) {
+	std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>> ltss = LoadPad();
+
+	auto automata = pcs::CompileResources(ltss);
+	pcs::CompleteTopology complete(automata);
+	pcs::SuccessorGenerator generator(automata);
+
+	// Topology-free reachability, only the visited states are stored
+	std::unordered_set<pcs::PackedState, pcs::PackedStateHash> visited;
+	std::queue<pcs::PackedState> queue;
+	size_t num_transitions = 0;
+	visited.emplace(generator.initial_state());
+	queue.push(generator.initial_state());
+	while (!queue.empty()) {
+		pcs::PackedState state = std::move(queue.front());
+		queue.pop();
+		for (const pcs::Successor& successor : generator.Successors(state)) {
+			++num_transitions;
+			if (visited.emplace(successor.state).second) {
+				queue.push(successor.state);
+			}
+		}
+	}
+	ASSERT_EQ(visited.size(), complete.lts().NumOfStates());
+	ASSERT_EQ(num_transitions, complete.lts().NumOfTransitions());
+
+	pcs::PackedState initial_state = generator.initial_state();
+	const auto& expected = complete.at(complete.initial_state());
+	size_t i = 0;
+	for (const pcs::Successor& successor : generator.Successors(initial_state)) {
+		ASSERT_LT(i, expected.transitions_.size());
+		ASSERT_EQ(std::make_pair(successor.resource, *successor.label), expected.transitions_[i].label());
+		ASSERT_EQ(generator.codec().Names(successor.state), expected.transitions_[i].to());
+		++i;
+	}
+	ASSERT_EQ(i, expected.transitions_.size());
+}
+
+TEST(ClusteredTopology, MatchesComplete) {
+	std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>> ltss = LoadPad();
+
+	auto automata = pcs::CompileResources(ltss);
+	pcs::CompleteTopology complete(automata);
+	pcs::ClusteredTopology clustered(automata, { { 4, 1 }, { 0, 2 }, { 3 } });
+	ASSERT_EQ(clustered.clusters(), std::vector<std::vector<size_t>>({ { 0, 2 }, { 1, 4 }, { 3 } }));
+	ASSERT_EQ(clustered.initial_state(), complete.initial_state());
+	for (const auto& [key, state] : complete.lts().states()) {
+		const auto& got = clustered.at(key);
+		ASSERT_EQ(got.transitions_.size(), state.transitions_.size());
+		for (size_t i = 0; i < got.transitions_.size(); ++i) {
+			ASSERT_EQ(got.transitions_[i].label(), state.transitions_[i].label());
+			ASSERT_EQ(got.transitions_[i].to(), state.transitions_[i].to());
+		}
+	}
+	size_t num_of_cluster_states = 0;
+	for (const auto& product : clustered.products()) {
+		num_of_cluster_states += product->NumOfStates();
+	}
+	ASSERT_LT(num_of_cluster_states, complete.lts().NumOfStates());
+
+	// A product can be shared by another topology with the same cluster
+	pcs::ClusteredTopology shared(automata, { { 0, 2 }, { 1, 3, 4 } }, { clustered.products()[0], nullptr });
+	ASSERT_EQ(shared.products()[0], clustered.products()[0]);
+	ASSERT_EQ(shared.at(complete.initial_state()).transitions_.size(), complete.at(complete.initial_state()).transitions_.size());
+
+	ASSERT_THROW(pcs::ClusteredTopology(automata, { { 0, 1 }, { 1, 2, 3, 4 } }), std::invalid_argument);
+}
+
+TEST(EstimateTopology, Pad) {
+	std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>> ltss = LoadPad();
+
+	auto automata = pcs::CompileResources(ltss);
+	pcs::CompleteTopology complete(automata);
+	const double num_states = static_cast<double>(complete.lts().NumOfStates());
+	const double branching_factor = static_cast<double>(complete.lts().NumOfTransitions()) / num_states;
+
+	pcs::TopologyEstimate estimate = pcs::EstimateTopology(automata);
+	ASSERT_LE(estimate.num_sampled_states, complete.lts().NumOfStates());
+	ASSERT_GE(estimate.num_states, num_states / 4);
+	ASSERT_LE(estimate.num_states, num_states * 4);
+	ASSERT_GE(estimate.branching_factor, branching_factor / 2);
+	ASSERT_LE(estimate.branching_factor, branching_factor * 2);
+	ASSERT_GT(estimate.num_bytes, 0);
+
+	pcs::TopologyEstimate again = pcs::EstimateTopology(automata);
+	ASSERT_EQ(again.num_states, estimate.num_states);
+}
+
+TEST(BitstateExplore, Pad) {
+	std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>> ltss = LoadPad();
+
+	auto automata = pcs::CompileResources(ltss);
+	pcs::CompleteTopology complete(automata);
+	std::unordered_set<uint32_t> operations;
+	for (const auto& automaton : *automata) {
+		for (uint32_t state = 0; state < automaton.NumOfStates(); ++state) {
+			for (const auto& label : automaton.labels(state)) {
+				if (label.IsObservable()) {
+					operations.emplace(label.operation_id());
+				}
+			}
+		}
+	}
+
+	pcs::BitstateReport report = pcs::BitstateExplore(automata, operations);
+	ASSERT_EQ(report.num_states, complete.lts().NumOfStates());
+	ASSERT_EQ(report.num_transitions, complete.lts().NumOfTransitions());
+	ASSERT_LT(report.omission_probability, 1e-6);
+	ASSERT_FALSE(report.reached_operations.empty());
+	for (uint32_t operation : report.reached_operations) {
+		ASSERT_TRUE(operations.contains(operation));
+	}
+
+	pcs::BitstateReport small = pcs::BitstateExplore(automata, operations, 64);
+	ASSERT_EQ(small.num_bits, 512);
+	ASSERT_LE(small.num_states, report.num_states);
+	ASSERT_GT(small.omission_probability, report.omission_probability);
+
+	// The search keeps one level per state on the current path, so a depth bound cuts it off
+	ASSERT_EQ(report.num_truncated, 0);
+	ASSERT_GT(report.depth, 3);
+	pcs::BitstateReport shallow = pcs::BitstateExplore(automata, operations, pcs::kBitstateMemoryBudget, pcs::kBitstateNumHashes, 3);
+	ASSERT_EQ(shallow.depth, 3);
+	ASSERT_GT(shallow.num_truncated, 0);
+	ASSERT_LT(shallow.num_states, report.num_states);
+}
+
+TEST(DistributedTopology, MatchesFrozen) {
+	std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>> ltss = LoadPad();
+
+	auto automata = pcs::CompileResources(ltss);
+	std::unique_ptr<pcs::FrozenTopology> frozen = pcs::CompleteTopology(automata).Freeze();
+	for (pcs::WorkerMode mode : { pcs::WorkerMode::process, pcs::WorkerMode::in_process }) {
+		std::unique_ptr<pcs::FrozenTopology> distributed = pcs::BuildDistributedTopology(automata, 3, mode);
+		ASSERT_EQ(distributed->NumOfStates(), frozen->NumOfStates());
+		ASSERT_EQ(distributed->NumOfTransitions(), frozen->NumOfTransitions());
+		ASSERT_EQ(distributed->NumOfLabels(), frozen->NumOfLabels());
+		// Workers number their own states, so states are matched by key
+		ASSERT_EQ(distributed->Key(0), frozen->Key(0));
+		for (uint32_t id = 0; id < frozen->NumOfStates(); ++id) {
+			auto expected = frozen->edges(id);
+			auto actual = distributed->edges(distributed->Id(frozen->Key(id)));
+			ASSERT_EQ(actual.size(), expected.size());
+			for (size_t e = 0; e < expected.size(); ++e) {
+				ASSERT_EQ(actual[e].resource, expected[e].resource);
+				ASSERT_EQ(distributed->label(actual[e].label), frozen->label(expected[e].label));
+				ASSERT_EQ(distributed->Key(actual[e].to), frozen->Key(expected[e].to));
+			}
+		}
+	}
+	ASSERT_THROW(pcs::BuildDistributedTopology(automata, 0), std::invalid_argument);
+
+#if defined(__linux__)
+	// Workers are not forked while another thread runs
+	std::promise<void> done;
+	std::thread other([future = done.get_future()]() { future.wait(); });
+	EXPECT_THROW(pcs::BuildDistributedTopology(automata, 2), std::logic_error);
+	done.set_value();
+	other.join();
+#endif
+}
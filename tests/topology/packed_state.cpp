@@ -0,0 +1,247 @@
+#include <gtest/gtest.h>
+#include "pcs/topology/state_codec.h"
+#include "pcs/topology/resource_automaton.h"
+#include "pcs/topology/transfer_index.h"
+#include "pcs/topology/packed_state_set.h"
+#include "pcs/topology/direct_index.h"
+#include "pcs/topology/delta_store.h"
+
+#include <vector>
+#include <string>
+#include <unordered_set>
+#include <stdexcept>
+
+#include "lts/lts.h"
+#include "lts/parsers/parsers.h"
+
+static nightly::LTS<std::string, pcs::ParameterizedOp> Chain(size_t num_states) {
+	nightly::LTS<std::string, pcs::ParameterizedOp> lts;
+	lts.set_initial_state("s0");
+	for (size_t i = 0; i + 1 < num_states; ++i) {
+		lts.AddTransition("s" + std::to_string(i), pcs::ParameterizedOp("a", pcs::Parameters()), "s" + std::to_string(i + 1));
+	}
+	return lts;
+}
+
+static void RoundTrip(const std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>>& ltss, pcs::StateCodec::Layout layout) {
+	pcs::StateCodec codec(ltss);
+	ASSERT_EQ(codec.layout(), layout);
+
+	std::vector<std::string> names;
+	for (size_t i = 0; i < ltss.size(); ++i) {
+		names.emplace_back("s" + std::to_string(i % codec.radix(i)));
+	}
+	pcs::PackedState packed = codec.Encode(names);
+	ASSERT_EQ(codec.Names(packed), names);
+
+	for (size_t i = 0; i < ltss.size(); ++i) {
+		pcs::PackedState next = packed;
+		uint32_t id = static_cast<uint32_t>(codec.radix(i) - 1);
+		codec.Set(next, i, id);
+		ASSERT_EQ(codec.Get(next, i), id);
+		std::vector<std::string> expected = names;
+		expected[i] = codec.Name(i, id);
+		ASSERT_EQ(codec.Names(next), expected);
+		ASSERT_EQ(codec.Encode(expected), next);
+	}
+}
+
+TEST(PackedState, InitialStateIsZero) {
+	std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>> ltss;
+	ltss.resize(2);
+	nightly::ReadFromFile(ltss[0], "../../data/pad/Resource1.txt");
+	nightly::ReadFromFile(ltss[1], "../../data/pad/Resource5.txt");
+	pcs::StateCodec codec(ltss);
+	pcs::PackedState packed = codec.Encode(std::vector<std::string>{ "s0", "s0" });
+	ASSERT_EQ(codec.Get(packed, 0), 0);
+	ASSERT_EQ(codec.Get(packed, 1), 0);
+}
+
+TEST(PackedState, MixedRadix) {
+	std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>> ltss;
+	for (size_t i = 0; i < 8; ++i) {
+		ltss.emplace_back(Chain(3 + i));
+	}
+	RoundTrip(ltss, pcs::StateCodec::Layout::MixedRadix);
+}
+
+TEST(PackedState, BitFields) {
+	std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>> ltss;
+	for (size_t i = 0; i < 40; ++i) {
+		ltss.emplace_back(Chain(5 + (i % 7)));
+	}
+	RoundTrip(ltss, pcs::StateCodec::Layout::BitFields);
+}
+
+TEST(ResourceAutomaton, Compiled) {
+	nightly::LTS<std::string, pcs::ParameterizedOp> lts = Chain(4);
+	lts.AddTransition("s1", pcs::ParameterizedOp("b", pcs::Parameters()), "s0");
+	pcs::ResourceAutomaton automaton(lts);
+	ASSERT_EQ(automaton.NumOfStates(), 4);
+	ASSERT_EQ(automaton.NumOfTransitions(), 4);
+	ASSERT_EQ(automaton.Id("s0"), 0);
+
+	uint32_t s1 = automaton.Id("s1");
+	ASSERT_EQ(automaton.targets(s1).size(), 2);
+	ASSERT_EQ(automaton.Name(automaton.targets(s1)[0]), "s2");
+	ASSERT_EQ(automaton.labels(s1)[0].operation(), "a");
+	ASSERT_EQ(automaton.Name(automaton.targets(s1)[1]), "s0");
+	ASSERT_EQ(automaton.labels(s1)[1].operation(), "b");
+	ASSERT_TRUE(automaton.targets(automaton.Id("s3")).empty());
+}
+
+TEST(ResourceAutomaton, Minimise) {
+	nightly::LTS<std::string, pcs::ParameterizedOp> lts;
+	lts.set_initial_state("s0");
+	lts.AddTransition("s0", pcs::ParameterizedOp("nop", pcs::Parameters()), "s0");
+	lts.AddTransition("s0", pcs::ParameterizedOp("a", pcs::Parameters()), "s1");
+	lts.AddTransition("s0", pcs::ParameterizedOp("b", pcs::Parameters()), "s2");
+	lts.AddTransition("s1", pcs::ParameterizedOp("c", pcs::Parameters()), "s0");
+	lts.AddTransition("s2", pcs::ParameterizedOp("c", pcs::Parameters()), "s0");
+
+	pcs::ResourceAutomaton minimised = pcs::ResourceAutomaton(lts).Minimise();
+	ASSERT_EQ(minimised.NumOfStates(), 2);
+	ASSERT_EQ(minimised.NumOfTransitions(), 4);
+	ASSERT_EQ(minimised.Id("s0"), 0);
+	ASSERT_EQ(minimised.Name(0), "s0");
+	ASSERT_EQ(minimised.Id("s1"), minimised.Id("s2"));
+	ASSERT_TRUE(minimised.HasNop(0));
+	ASSERT_FALSE(minimised.HasNop(minimised.Id("s1")));
+	ASSERT_EQ(minimised.Name(minimised.targets(minimised.Id("s2"))[0]), "s0");
+
+	// Every state of a chain has a different distance to its end
+	ASSERT_EQ(pcs::ResourceAutomaton(Chain(4)).Minimise().NumOfStates(), 4);
+}
+
+TEST(TransferIndex, LargeTransferNumbers) {
+	nightly::LTS<std::string, pcs::ParameterizedOp> lts;
+	lts.set_initial_state("s0");
+	lts.AddTransition("s0", pcs::ParameterizedOp("a", pcs::Parameters()), "s1");
+	for (uint64_t k = 1; k <= 3; ++k) {
+		lts.AddTransition("s0", pcs::ParameterizedOp("in:" + std::to_string(k << 31), pcs::Parameters()), "s2");
+	}
+	lts.AddTransition("s1", pcs::ParameterizedOp("in:0", pcs::Parameters()), "s3");
+	std::vector<pcs::ResourceAutomaton> automata{ pcs::ResourceAutomaton(lts) };
+	const pcs::ResourceAutomaton& automaton = automata[0];
+
+	// With n shifted into the bits of the local state, (s0, in:k * 2^31) and (s1, in:0) shared a key for k = id of s1
+	pcs::TransferIndex index(automata);
+	for (uint64_t k = 1; k <= 3; ++k) {
+		ASSERT_EQ(index.Target(0, automaton.Id("s0"), pcs::TransferType::in, k << 31), automaton.Id("s2"));
+		ASSERT_FALSE(index.Target(0, automaton.Id("s1"), pcs::TransferType::in, k << 31).has_value());
+	}
+	ASSERT_EQ(index.Target(0, automaton.Id("s1"), pcs::TransferType::in, 0), automaton.Id("s3"));
+
+	lts.AddTransition("s3", pcs::ParameterizedOp("out:9223372036854775808", pcs::Parameters()), "s0");
+	ASSERT_THROW(pcs::TransferIndex(std::vector<pcs::ResourceAutomaton>{ pcs::ResourceAutomaton(lts) }), std::invalid_argument);
+}
+
+TEST(PackedStateSet, InsertContains) {
+	// Three words, so keys spill out of the inline words of PackedState
+	auto key = [](uint64_t i) {
+		pcs::PackedState state(3);
+		state.set_word(0, i * 0x9E3779B97F4A7C15ull);
+		state.set_word(1, i % 7);
+		state.set_word(2, i);
+		return state;
+	};
+
+	pcs::PackedStateSet set;
+	std::unordered_set<pcs::PackedState, pcs::PackedStateHash> expected;
+	ASSERT_TRUE(set.empty());
+	ASSERT_FALSE(set.Contains(key(0)));
+	for (uint64_t i = 0; i < 10000; ++i) {
+		ASSERT_EQ(set.Insert(key(i % 6000)), expected.emplace(key(i % 6000)).second);
+	}
+	ASSERT_EQ(set.size(), expected.size());
+	for (uint64_t i = 0; i < 7000; ++i) {
+		ASSERT_EQ(set.Contains(key(i)), i < 6000);
+	}
+
+	size_t num_keys = 0;
+	set.ForEach([&](const pcs::PackedState& state) {
+		ASSERT_TRUE(expected.contains(state));
+		++num_keys;
+	});
+	ASSERT_EQ(num_keys, expected.size());
+}
+
+TEST(DirectStateIndex, InsertRank) {
+	pcs::StateCodec codec(std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>>{ Chain(10), Chain(20), Chain(30) });
+	ASSERT_EQ(pcs::DirectStateIndex::NumOfCodes(codec), 6000);
+	ASSERT_TRUE(pcs::DirectStateIndex::Fits(codec));
+	ASSERT_FALSE(pcs::DirectStateIndex::Fits(codec, 5999));
+	ASSERT_THROW(pcs::DirectStateIndex(codec, 5999), std::invalid_argument);
+
+	auto key = [](uint64_t code) {
+		pcs::PackedState state(1);
+		state.set_word(0, code);
+		return state;
+	};
+	pcs::DirectStateIndex index(codec);
+	for (uint64_t code = 0; code < 6000; code += 3) {
+		ASSERT_TRUE(index.Insert(key(code)));
+		ASSERT_FALSE(index.Insert(key(code)));
+	}
+	ASSERT_EQ(index.size(), 2000);
+	index.IndexRanks();
+	for (uint64_t code = 0; code < 6000; ++code) {
+		ASSERT_EQ(index.Contains(key(code)), code % 3 == 0);
+		if (code % 3 == 0) {
+			ASSERT_EQ(index.Rank(key(code)), code / 3);
+		}
+	}
+
+	uint64_t expected = 0;
+	index.ForEach([&](const pcs::PackedState& state) {
+		ASSERT_EQ(state.word(0), expected);
+		expected += 3;
+	});
+	ASSERT_EQ(expected, 6000);
+}
+
+TEST(DeltaStateStore, WideStates) {
+	// 200 resources of 2 bits each take 7 words per state, wide enough for deltas to pay
+	auto automata = pcs::CompileResources(std::vector<nightly::LTS<std::string, pcs::ParameterizedOp>>(200, Chain(4)));
+	pcs::StateCodec codec(automata);
+	ASSERT_EQ(codec.NumOfWords(), 7);
+	ASSERT_TRUE(pcs::DeltaStateStore::Pays(codec.NumOfWords(), 16));
+	ASSERT_FALSE(pcs::DeltaStateStore::Pays(1, 16));
+	ASSERT_FALSE(pcs::DeltaStateStore::Pays(codec.NumOfWords(), 1));
+
+	pcs::DeltaStateStore full(automata, 1);
+	pcs::DeltaStateStore delta(automata, 16);
+	// Long delta chains are decoded without recursion
+	pcs::DeltaStateStore deep(automata, UINT16_MAX);
+	ASSERT_FALSE(full.IsDelta());
+	ASSERT_TRUE(delta.IsDelta());
+
+	// A walk that moves one resource per step, every state interned as a delta from the one before
+	std::vector<pcs::PackedState> states{ pcs::PackedState(codec.NumOfWords()) };
+	for (size_t k = 1; k < 3000; ++k) {
+		pcs::PackedState next = states.back();
+		size_t i = (k * 7) % 200;
+		codec.Set(next, i, (codec.Get(next, i) + 1) % 4);
+		states.emplace_back(std::move(next));
+	}
+	uint32_t parent = pcs::DeltaStateStore::kNone;
+	for (const auto& state : states) {
+		auto [id, inserted] = full.Intern(state);
+		ASSERT_EQ(delta.Intern(state, parent), std::make_pair(id, inserted));
+		ASSERT_EQ(deep.Intern(state, parent), std::make_pair(id, inserted));
+		parent = id;
+	}
+	ASSERT_EQ(delta.size(), full.size());
+	ASSERT_LT(delta.NumOfCheckpoints(), delta.size());
+	ASSERT_EQ(deep.NumOfCheckpoints(), 1);
+	ASSERT_LT(delta.MemoryUsage(), full.MemoryUsage());
+
+	for (uint32_t id = 0; id < full.size(); ++id) {
+		pcs::PackedState state = full.Decode(id);
+		ASSERT_EQ(delta.Decode(id), state);
+		ASSERT_EQ(deep.Decode(id), state);
+		ASSERT_EQ(delta.Find(state), id);
+		// The Zobrist hash does not depend on how the state is encoded
+		ASSERT_EQ(delta.Hash(id), full.Hash(id));
+	}
+}